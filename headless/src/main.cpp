@@ -0,0 +1,92 @@
+// main.cpp
+
+#include "world.hpp"
+#include "entity.hpp"
+#include "fixed_step.hpp"
+#include "input_source.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// note: runs the simulation with no window, GPU or audio device, as fast as it goes.
+//       usage: headless [ticks] [seed] [width height]
+//       Nothing here touches raylib, a seed always replays the same run.
+namespace headless
+{
+    using sim::Point;
+    using sim::World;
+
+    constexpr int REPORT_INTERVAL = 3600; // note: one simulated minute at the default rate
+
+    struct Census {
+        int m_sheep = 0;
+        int m_wolves = 0;
+        int m_grass = 0;
+    };
+
+    Census take_census(const World& world)
+    {
+        Census census;
+        for (int i = 0; i < world.m_sheep.size(); i++) {
+            if (world.m_sheep.m_state[i] != sim::Sheep::SheepState::DEAD) {
+                census.m_sheep++;
+            }
+        }
+        for (const sim::Wolf& wolf : world.m_wolf) {
+            if (wolf.m_state != sim::Wolf::WolfState::DEAD) {
+                census.m_wolves++;
+            }
+        }
+        world.m_grass.for_each_alive([&census](const Point&, sim::Grass::GrassState) { census.m_grass++; });
+        return census;
+    }
+
+    void report(const World& world, long long tick)
+    {
+        const Census census = take_census(world);
+        std::printf("%10lld %8d %8d %8d\n", tick, census.m_sheep, census.m_wolves, census.m_grass);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    using namespace headless;
+
+    const long long ticks = argc > 1 ? std::strtoll(argv[1], nullptr, 10) : 7200;
+    const uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1u;
+    const Point size = argc > 4 ? Point(std::atoi(argv[3]), std::atoi(argv[4])) : Point(57, 31); // note: what World::init makes of a 1920x1080 window
+    if (ticks < 0 || size.x <= 0 || size.y <= 0) {
+        std::fprintf(stderr, "usage: headless [ticks] [seed] [width height]\n");
+        return EXIT_FAILURE;
+    }
+
+    static World world;
+    const sim::NoInput input;
+    const sim::FixedStep clock;
+    world.m_random.seed(seed);
+    world.init(size, 0, 0, nullptr, nullptr, nullptr);
+
+    std::printf("%d x %d tiles, seed %llu, %lld ticks of %.4f s\n", size.x, size.y, (unsigned long long)seed, ticks, clock.step());
+    std::printf("%10s %8s %8s %8s\n", "tick", "sheep", "wolves", "grass");
+    report(world, 0);
+
+    const auto start = std::chrono::steady_clock::now();
+    long long tick = 0;
+    while (tick < ticks) {
+        world.handle_input(input);
+        if (!world.update(clock.step())) {
+            break;
+        }
+        tick++;
+        if (tick % REPORT_INTERVAL == 0) {
+            report(world, tick);
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (tick % REPORT_INTERVAL != 0) {
+        report(world, tick);
+    }
+    std::printf("\n%lld ticks in %.3f s, %.0f ticks per second\n", tick, seconds, seconds > 0.0 ? double(tick) / seconds : 0.0);
+    return EXIT_SUCCESS;
+}
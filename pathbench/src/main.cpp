@@ -0,0 +1,404 @@
+// main.cpp
+
+#include "world.hpp"
+#include "entity.hpp"
+#include "dstar_lite.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <new>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+// note: every allocation made while a query runs is counted, the benchmark is single threaded
+static uint64_t g_allocations = 0;
+
+void* operator new(std::size_t size)
+{
+    g_allocations++;
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+namespace bench
+{
+    using sim::Point;
+    using sim::World;
+
+    struct Variant {
+        const char* m_name;
+        bool m_exact; // note: must match the reference length, otherwise only reachability has to match
+        std::function<std::vector<Point>(World&, const Point&, const Point&)> m_solve;
+        std::function<uint64_t()> m_expansions;
+    };
+
+    struct Query {
+        Point m_start;
+        Point m_goal;
+    };
+
+    struct Scenario {
+        std::string m_name;
+        std::function<void(World&, std::mt19937&)> m_build; // note: fills m_walkable, may edit afterwards
+        std::function<Query(const World&, std::mt19937&)> m_query;
+    };
+
+    struct Result {
+        std::vector<double> m_micros;
+        uint64_t m_found = 0;
+        uint64_t m_expansions = 0;
+        uint64_t m_allocations = 0;
+        uint64_t m_length_mismatches = 0;
+        uint64_t m_reach_mismatches = 0;
+        uint64_t m_broken_paths = 0;
+        double m_length_ratio = 0.0; // note: summed over queries both found
+    };
+
+    constexpr int QUERIES_PER_SCENARIO = 400;
+
+    void reset_ground(World& world, const Point& size, bool walkable)
+    {
+        world.m_world_size = size;
+        world.m_walkable.reset(size, walkable);
+    }
+
+    Point random_tile(const World& world, std::mt19937& rng)
+    {
+        return Point(int(rng() % world.m_world_size.x), int(rng() % world.m_world_size.y));
+    }
+
+    Point random_walkable(const World& world, std::mt19937& rng)
+    {
+        for (int attempt = 0; attempt < 1000; attempt++) {
+            const Point coord = random_tile(world, rng);
+            if (world.is_walkable(coord)) {
+                return coord;
+            }
+        }
+        return random_tile(world, rng);
+    }
+
+    Query any_pair(const World& world, std::mt19937& rng)
+    {
+        return { random_walkable(world, rng), random_walkable(world, rng) };
+    }
+
+    void random_obstacles(World& world, std::mt19937& rng, const Point& size, int percent)
+    {
+        reset_ground(world, size, true);
+        for (int y = 0; y < size.y; y++) {
+            for (int x = 0; x < size.x; x++) {
+                world.m_walkable.set(Point(x, y), int(rng() % 100) >= percent);
+            }
+        }
+        world.rebuild_navigation();
+    }
+
+    void maze(World& world, std::mt19937& rng, const Point& size)
+    {
+        //Recursive backtracker over the odd tiles, walls in between
+        reset_ground(world, size, false);
+        std::vector<Point> stack{ Point(1, 1) };
+        world.m_walkable.set(Point(1, 1), true);
+        const Point steps[] = { {0, -2}, {0, 2}, {-2, 0}, {2, 0} };
+        while (!stack.empty()) {
+            const Point at = stack.back();
+            Point options[4];
+            int count = 0;
+            for (const Point& step : steps) {
+                const Point next = at + step;
+                if (next.x > 0 && next.y > 0 && next.x < size.x - 1 && next.y < size.y - 1 &&
+                    !world.m_walkable.test(next)) {
+                    options[count++] = next;
+                }
+            }
+            if (count == 0) {
+                stack.pop_back();
+                continue;
+            }
+            const Point next = options[rng() % count];
+            const Point wall((at.x + next.x) / 2, (at.y + next.y) / 2);
+            world.m_walkable.set(wall, true);
+            world.m_walkable.set(next, true);
+            stack.push_back(next);
+        }
+        world.rebuild_navigation();
+    }
+
+    void walled_goals(World& world, std::mt19937& rng, const Point& size)
+    {
+        //Sealed rooms scattered over a light obstacle field, queries target their insides
+        random_obstacles(world, rng, size, 10);
+        for (int room = 0; room < 6; room++) {
+            const Point corner(2 + int(rng() % (size.x - 8)), 2 + int(rng() % (size.y - 8)));
+            for (int i = 0; i <= 4; i++) {
+                world.set_walkable(corner + Point(i, 0), false);
+                world.set_walkable(corner + Point(i, 4), false);
+                world.set_walkable(corner + Point(0, i), false);
+                world.set_walkable(corner + Point(4, i), false);
+            }
+            for (int y = 1; y < 4; y++) {
+                for (int x = 1; x < 4; x++) {
+                    world.set_walkable(corner + Point(x, y), true);
+                }
+            }
+        }
+    }
+
+    Query into_room(const World& world, std::mt19937& rng)
+    {
+        //Goals inside the sealed rooms, i.e. in one of the small regions the start is not part of
+        Query query = any_pair(world, rng);
+        const sim::WalkableComponents& components = world.m_components;
+        std::vector<Point> candidates;
+        for (int y = 0; y < world.m_world_size.y; y++) {
+            for (int x = 0; x < world.m_world_size.x; x++) {
+                const int region = components.component(Point(x, y));
+                if (region != sim::WalkableComponents::NONE && region != components.component(query.m_start) &&
+                    components.m_id_size[region] <= 9) {
+                    candidates.push_back(Point(x, y));
+                }
+            }
+        }
+        if (!candidates.empty()) {
+            query.m_goal = candidates[rng() % candidates.size()];
+        }
+        return query;
+    }
+
+    void painted_walls(World& world, std::mt19937& rng, const Point& size)
+    {
+        //Brush strokes through set_walkable, like walls drawn in the editor, so the incremental repairs get used
+        reset_ground(world, size, true);
+        world.rebuild_navigation();
+        const int strokes = (size.x * size.y) / 150;
+        for (int stroke = 0; stroke < strokes; stroke++) {
+            Point at = random_tile(world, rng);
+            const bool horizontal = rng() % 2 == 0;
+            const int length = 4 + int(rng() % 16);
+            for (int i = 0; i < length; i++) {
+                world.set_walkable(at, false);
+                if (rng() % 5 == 0) {
+                    at = at + (horizontal ? Point(0, rng() % 2 ? 1 : -1) : Point(rng() % 2 ? 1 : -1, 0));
+                }
+                else {
+                    at = at + (horizontal ? Point(1, 0) : Point(0, 1));
+                }
+            }
+        }
+    }
+
+    bool is_valid_path(const World& world, const std::vector<Point>& path, const Query& query)
+    {
+        if (path.empty()) {
+            return true;
+        }
+        if (!(path.front() == query.m_start) || !(path.back() == query.m_goal)) {
+            return false;
+        }
+        for (size_t i = 1; i < path.size(); i++) {
+            const int step = std::abs(path[i].x - path[i - 1].x) + std::abs(path[i].y - path[i - 1].y);
+            if (step != 1 || !world.is_walkable(path[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // note: plain A* over a std::priority_queue with fresh arrays for every query. It shares nothing with
+    //       the game's searches, so a regression in them shows up as a mismatch against it
+    std::vector<Point> reference_path(const World& world, const Point& start, const Point& goal)
+    {
+        const Point size = world.m_world_size;
+        auto index = [&size](const Point& p) { return p.y * size.x + p.x; };
+        std::vector<int> g(size_t(size.x) * size_t(size.y), std::numeric_limits<int>::max());
+        std::vector<int> parent(g.size(), -1);
+        using Entry = std::pair<int, int>; // note: fCost, tile index
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+
+        g[index(start)] = 0;
+        open.push({ heuristic(start, goal), index(start) });
+        const Point directions[] = { {0, -1}, {0, 1}, {-1, 0}, {1, 0} };
+        while (!open.empty()) {
+            const auto [f, current] = open.top();
+            open.pop();
+            const Point at(current % size.x, current / size.x);
+            if (f - heuristic(at, goal) > g[current]) {
+                continue; //Queued before a shorter way to the tile was found
+            }
+            if (at == goal) {
+                std::vector<Point> path;
+                for (int node = current; node != -1; node = parent[node]) {
+                    path.push_back(Point(node % size.x, node / size.x));
+                }
+                std::reverse(path.begin(), path.end());
+                return path;
+            }
+            for (const Point& d : directions) {
+                const Point next = at + d;
+                if (!world.is_walkable(next)) {
+                    continue;
+                }
+                const int cost = g[current] + 1;
+                if (cost < g[index(next)]) {
+                    g[index(next)] = cost;
+                    parent[index(next)] = current;
+                    open.push({ cost + heuristic(next, goal), index(next) });
+                }
+            }
+        }
+        return {};
+    }
+
+    double percentile(std::vector<double>& values, double fraction)
+    {
+        if (values.empty()) {
+            return 0.0;
+        }
+        const size_t index = std::min(values.size() - 1, size_t(fraction * double(values.size())));
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+
+    bool run_scenario(World& world, const Scenario& scenario, std::vector<Variant>& variants, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        scenario.m_build(world, rng);
+
+        std::vector<Query> queries(QUERIES_PER_SCENARIO);
+        for (Query& query : queries) {
+            query = scenario.m_query(world, rng);
+        }
+
+        //Every variant is checked against the benchmark's own A*, not against one of the game's searches
+        std::vector<std::vector<Point>> reference(queries.size());
+        for (size_t i = 0; i < queries.size(); i++) {
+            reference[i] = reference_path(world, queries[i].m_start, queries[i].m_goal);
+        }
+
+        std::printf("\n%s (%dx%d)\n", scenario.m_name.c_str(), world.m_world_size.x, world.m_world_size.y);
+        std::printf("  %-12s %7s %10s %8s %9s %9s %9s %9s %8s %8s\n",
+            "variant", "found", "expanded", "allocs", "p50 us", "p90 us", "p99 us", "max us", "len err", "ratio");
+
+        bool ok = true;
+        for (Variant& variant : variants) {
+            Result result;
+            result.m_micros.reserve(queries.size());
+            for (size_t i = 0; i < queries.size(); i++) {
+                const Query& query = queries[i];
+                const uint64_t expansions = variant.m_expansions();
+                const uint64_t allocations = g_allocations;
+                const auto begin = std::chrono::steady_clock::now();
+                std::vector<Point> path = variant.m_solve(world, query.m_start, query.m_goal);
+                const auto end = std::chrono::steady_clock::now();
+                result.m_allocations += g_allocations - allocations;
+                result.m_expansions += variant.m_expansions() - expansions;
+                result.m_micros.push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+
+                if (!is_valid_path(world, path, query)) {
+                    result.m_broken_paths++;
+                }
+                if (path.empty() != reference[i].empty()) {
+                    result.m_reach_mismatches++;
+                }
+                else if (!path.empty()) {
+                    result.m_found++;
+                    result.m_length_ratio += double(path.size()) / double(reference[i].size());
+                    if (variant.m_exact && path.size() != reference[i].size()) {
+                        result.m_length_mismatches++;
+                    }
+                }
+            }
+
+            const double count = double(queries.size());
+            std::printf("  %-12s %7llu %10.1f %8.2f %9.1f %9.1f %9.1f %9.1f %8llu %8.4f\n",
+                variant.m_name,
+                (unsigned long long)result.m_found,
+                double(result.m_expansions) / count,
+                double(result.m_allocations) / count,
+                percentile(result.m_micros, 0.50),
+                percentile(result.m_micros, 0.90),
+                percentile(result.m_micros, 0.99),
+                *std::max_element(result.m_micros.begin(), result.m_micros.end()),
+                (unsigned long long)result.m_length_mismatches,
+                result.m_found ? result.m_length_ratio / double(result.m_found) : 1.0);
+            if (result.m_reach_mismatches || result.m_broken_paths || result.m_length_mismatches) {
+                std::printf("  !! %s: %llu reachability mismatches, %llu broken paths, %llu length mismatches\n",
+                    variant.m_name,
+                    (unsigned long long)result.m_reach_mismatches,
+                    (unsigned long long)result.m_broken_paths,
+                    (unsigned long long)result.m_length_mismatches);
+                ok = false;
+            }
+        }
+        return ok;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    using namespace bench;
+
+    const uint32_t seed = argc > 1 ? uint32_t(std::strtoul(argv[1], nullptr, 10)) : 1u;
+    const Point game_size(57, 31); // note: what World::init makes of a 1920x1080 window
+    const Point large_size(256, 256);
+
+    // note: one world for every scenario, rebuild_navigation() starts a new walkability epoch each time
+    //       so the planner below knows to throw its search tree away
+    static World world;
+    sim::DStarLite planner; // note: kept across queries, as each wolf keeps its own
+    std::vector<Variant> variants = {
+        { "astar", true,
+          [](World& world, const Point& start, const Point& goal) { return sim::findPath(world, start, goal, sim::PathAlgorithm::AStar); },
+          [] { return sim::search_context().m_expansions; } },
+        { "jps", true,
+          [](World& world, const Point& start, const Point& goal) { return sim::findPath(world, start, goal, sim::PathAlgorithm::JumpPoint); },
+          [] { return sim::search_context().m_expansions; } },
+        { "hierarchical", false,
+          [](World& world, const Point& start, const Point& goal) { return sim::findPath(world, start, goal, sim::PathAlgorithm::Hierarchical); },
+          [] { return sim::search_context().m_expansions; } },
+        { "dstar-lite", true,
+          [&planner](World& world, const Point& start, const Point& goal) { return planner.plan(world, start, goal); },
+          [&planner] { return planner.m_expansions; } },
+    };
+
+    std::vector<Scenario> scenarios;
+    for (const Point& size : { game_size, large_size }) {
+        scenarios.push_back({ "open field",
+            [size](World& world, std::mt19937& rng) { random_obstacles(world, rng, size, 0); }, any_pair });
+        for (int percent : { 10, 25, 40 }) {
+            scenarios.push_back({ "random obstacles " + std::to_string(percent) + "%",
+                [size, percent](World& world, std::mt19937& rng) { random_obstacles(world, rng, size, percent); }, any_pair });
+        }
+        scenarios.push_back({ "maze",
+            [size](World& world, std::mt19937& rng) { maze(world, rng, size); }, any_pair });
+        scenarios.push_back({ "walled-off goals",
+            [size](World& world, std::mt19937& rng) { walled_goals(world, rng, size); }, into_room });
+        scenarios.push_back({ "painted walls",
+            [size](World& world, std::mt19937& rng) { painted_walls(world, rng, size); }, any_pair });
+    }
+
+    bool ok = true;
+    for (size_t i = 0; i < scenarios.size(); i++) {
+        ok = run_scenario(world, scenarios[i], variants, seed + uint32_t(i)) && ok;
+    }
+    std::printf("\n%s\n", ok ? "all variants agree with the reference priority-queue A*" : "MISMATCHES FOUND");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -4,6 +4,7 @@
 
 #include "world.hpp"
 #include "editor.hpp"
+#include "fixed_step.hpp"
 
 namespace sim
 {
@@ -22,6 +23,8 @@ namespace sim
 
       bool m_running = true;
       Mode m_mode{};
+      RaylibInput m_input;
+      FixedStep m_clock; // note: the world only ever advances in whole ticks of m_clock.step()
       Texture m_texture{};
       Texture m_wolfTexture{};
       Texture m_herderTexture{};
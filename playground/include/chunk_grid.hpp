@@ -0,0 +1,86 @@
+// chunk_grid.hpp
+
+#pragma once
+
+#include "common.hpp"
+#include <memory>
+#include <vector>
+
+namespace sim
+{
+    struct Chunk {
+        static constexpr int SIZE_BITS = 5;
+        static constexpr int SIZE = 1 << SIZE_BITS;
+        static constexpr int TILES = SIZE * SIZE;
+
+        // note: chunks needed to cover `size` tiles along each axis
+        static constexpr Point count_for(const Point& size)
+        {
+            return Point((size.x + SIZE - 1) >> SIZE_BITS, (size.y + SIZE - 1) >> SIZE_BITS);
+        }
+        static constexpr Point coord_of(const Point& tile) { return Point(tile.x >> SIZE_BITS, tile.y >> SIZE_BITS); }
+        static constexpr int local_of(const Point& tile) { return ((tile.y & (SIZE - 1)) << SIZE_BITS) | (tile.x & (SIZE - 1)); }
+        static constexpr Point tile_of(const Point& chunk, int local)
+        {
+            return Point((chunk.x << SIZE_BITS) | (local & (SIZE - 1)), (chunk.y << SIZE_BITS) | (local >> SIZE_BITS));
+        }
+    };
+
+    // note: one value per tile of a world-sized grid, stored in chunks of Chunk::SIZE x Chunk::SIZE that are
+    //       only allocated once written to. Reads of a chunk never written see `fill`. Callers check coords
+    //       against the world size, tiles past the edge of the last chunks exist but are never used.
+    template <typename T>
+    struct ChunkGrid {
+        void reset(const Point& size, const T& fill)
+        {
+            m_size = size;
+            m_count = Chunk::count_for(size);
+            m_fill = fill;
+            m_chunks.clear();
+            m_chunks.resize(size_t(m_count.x) * size_t(m_count.y));
+        }
+
+        int chunk_index(const Point& tile) const
+        {
+            const Point chunk = Chunk::coord_of(tile);
+            return chunk.y * m_count.x + chunk.x;
+        }
+        Point chunk_coord(int chunk) const { return Point(chunk % m_count.x, chunk / m_count.x); }
+        int chunk_count() const { return (int)m_chunks.size(); }
+        bool is_allocated(int chunk) const { return m_chunks[chunk] != nullptr; }
+        int allocated_count() const
+        {
+            int count = 0;
+            for (const auto& chunk : m_chunks) {
+                count += chunk ? 1 : 0;
+            }
+            return count;
+        }
+
+        const T& get(const Point& tile) const
+        {
+            const T* data = m_chunks[chunk_index(tile)].get();
+            return data ? data[Chunk::local_of(tile)] : m_fill;
+        }
+        // note: allocates the chunk on first use
+        T& at(const Point& tile) { return chunk(chunk_index(tile))[Chunk::local_of(tile)]; }
+        // note: nullptr for a chunk never written
+        const T* data(int chunk) const { return m_chunks[chunk].get(); }
+        T* chunk(int index)
+        {
+            std::unique_ptr<T[]>& data = m_chunks[index];
+            if (!data) {
+                data = std::make_unique<T[]>(Chunk::TILES);
+                for (int i = 0; i < Chunk::TILES; i++) {
+                    data[i] = m_fill;
+                }
+            }
+            return data.get();
+        }
+
+        Point m_size;
+        Point m_count;
+        T m_fill{};
+        std::vector<std::unique_ptr<T[]>> m_chunks;
+    };
+}
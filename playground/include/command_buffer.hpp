@@ -0,0 +1,38 @@
+// command_buffer.hpp
+
+#pragma once
+
+#include "common.hpp"
+#include "handle.hpp"
+#include <vector>
+
+namespace sim
+{
+    struct World;
+
+    // note: births and deaths asked for while World::update walks the entities. Nothing moves until
+    //       apply runs at the end of the tick, then the dead leave in one pass that keeps everyone
+    //       else in order and the newborn are appended in the order they were asked for.
+    struct CommandBuffer {
+        struct SheepSpawn {
+            Vector2 m_position;
+            Vector2 m_direction;
+            float m_radius;
+            Rectangle m_source;
+            Vector2 m_origin;
+        };
+
+        void spawn_sheep(const SheepSpawn& spawn);
+        void despawn_sheep(const Handle& sheep);
+        // note: a sheep caught by several wolves in one tick is eaten once
+        void eat_sheep(const Handle& sheep);
+        bool empty() const { return m_sheep_spawns.empty() && m_sheep_despawns.empty() && m_sheep_eaten.empty(); }
+        // note: also sweeps the wolves that died during the tick
+        void apply(World& world);
+
+        std::vector<SheepSpawn> m_sheep_spawns;
+        std::vector<Handle> m_sheep_despawns;
+        std::vector<Handle> m_sheep_eaten;
+        std::vector<int> m_remap; // note: scratch for the wolf sweep
+    };
+}
@@ -0,0 +1,69 @@
+// dstar_lite.hpp
+
+#pragma once
+
+#include "common.hpp"
+#include "pathfinding.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace sim
+{
+    struct World;
+
+    // note: incremental planner for a chaser whose goal keeps moving (Moving Target D* Lite).
+    //       The search tree is rooted at the chaser and kept between calls: a moved goal only
+    //       raises the key modifier, a moved root and walkability edits only re-queue the tiles
+    //       whose one-step lookahead changed, and replanning repairs what became inconsistent.
+    //       Search state lives in pages of tiles allocated as the search first reaches them, a wolf
+    //       only pays for the part of the map its searches cover.
+    struct DStarLite {
+        static constexpr int UNREACHED = PathSearchContext::UNREACHED;
+        static constexpr int PAGE_BITS = IndexedHeap::PAGE_BITS;
+        static constexpr int PAGE_SIZE = 1 << PAGE_BITS;
+
+        struct Node {
+            uint32_t m_stamp = 0; // note: g and rhs only count when this is the current generation
+            int m_g = UNREACHED;
+            int m_rhs = UNREACHED;
+        };
+
+        std::vector<Point> plan(const World& world, const Point& start, const Point& goal);
+        void reset(const World& world, const Point& start, const Point& goal);
+
+        // note: nullptr for a tile on a page never written, its g and rhs are UNREACHED
+        const Node* node(int index) const
+        {
+            const Node* page = m_pages[index >> PAGE_BITS].get();
+            return page && page[index & (PAGE_SIZE - 1)].m_stamp == m_generation ? &page[index & (PAGE_SIZE - 1)] : nullptr;
+        }
+        int g(int index) const
+        {
+            const Node* current = node(index);
+            return current ? current->m_g : UNREACHED;
+        }
+        int rhs(int index) const
+        {
+            const Node* current = node(index);
+            return current ? current->m_rhs : UNREACHED;
+        }
+        void set(int index, int g, int rhs);
+        int heuristic_to_goal(int index) const;
+        uint64_t key(int index) const;
+        void update_vertex(const World& world, int index);
+        void compute_path(const World& world);
+        void apply_walkability_changes(const World& world);
+
+        Point m_size;
+        Point m_start{ -1, -1 };
+        Point m_goal{ -1, -1 };
+        int m_km = 0;
+        uint32_t m_walkability_epoch = 0;
+        uint32_t m_generation = 0;
+        std::vector<std::unique_ptr<Node[]>> m_pages;
+        IndexedHeap m_open;
+        std::vector<Point> m_changes;
+        uint64_t m_expansions = 0; // note: total over the planner's lifetime, for profiling
+    };
+}
@@ -6,6 +6,10 @@
 #include "world.hpp"
 #include <memory>
 #include "pathfinding.h"
+#include "dstar_lite.hpp"
+#include "grass_layer.hpp"
+#include "path.hpp"
+#include "sheep_store.hpp"
 
 namespace sim
 {
@@ -20,85 +24,6 @@ namespace sim
     constexpr float REPRODUCTION_PAUSE_TIME = 1.5f;
 
     struct World;
-    struct Ground {
-        Ground() = default;
-
-        bool is_walkable() const;
-        void set_walkable(bool state);
-        void set_tile_coord(const Point& coord);
-
-        Point m_tile_coord;
-        bool  m_walkable{};
-    };
-
-    struct Grass {
-        Grass() = default;
-        enum class GrassState { NONE, SEED, GERMINATION, GROWN, WILT, EATEN };
-        void eatenBySheep();
-        void update(float dt);
-        bool is_alive() const;
-        float get_age() const;
-        void set_age(float age);
-        void set_tile_coord(const Point& coord);
-
-        bool m_hasFertilizer = false;
-        float m_updateTimer = 0.0f;
-        float m_regrowTimer = 0.0f;
-        Point m_tile_coord;
-        float m_age{};
-        GrassState m_state{ GrassState::SEED };
-    };
-
-    struct Sheep : public std::enable_shared_from_this<Sheep> {
-        int HP = SHEEP_MAX_HP;
-        static constexpr float WALKING_SPEED = 70.0f;
-        static constexpr float RUNNING_SPEED = 150.0f;
-        constexpr static float REPRODUCTION_COOLDOWN_TIME = 2.0f;
-        float m_reproductionCooldown = 2.0f;
-        std::weak_ptr<Sheep> reproductionPartner;
-        std::vector<Point> m_path;
-        float m_updateTimer = 0.0f;
-        float m_reproduceTimer = 0.0f;
-        bool m_isFull = false;           
-        float m_satietyTimer = 0.0f;    
-        const float FULL_DURATION = 5.0f;
-
-        World* m_world;
-        Sheep(World& world) : m_world(&world), m_reproductionCooldown(REPRODUCTION_COOLDOWN_TIME), m_updateTimer(0.0f) {}
-        enum class SheepState { WANDERING, SEEKING, EATING, ESCAPING, DEAD, REPRODUCE };
-
-        void set_position(const Vector2& position);
-        void set_direction(const Vector2& direction);
-        void set_radius(float radius);
-        void set_sprite_flip_x(bool state);
-        void set_sprite_origin(const Vector2& origin);
-        void set_sprite_source(const Rectangle& source);
-
-        void update(float dt);
-        void sense();
-        void decide(float dt);
-        void act(float dt);
-        void render(const Texture& texture) const;
-        void getEaten();
-        SheepState getState() const { return m_state; }
-        void recalculatePath();
-
-        Vector2   m_position{};
-        Vector2   m_direction{};
-        float     m_radius{};
-        bool      m_flip_x{};
-        Vector2   m_origin{};
-        Rectangle m_source{};
-        SheepState m_state{ SheepState::WANDERING };
-        bool manureExists{ false };
-
-        float m_hunger{ 0.0f };
-        float m_eatingTimer{ 0.0f };
-        bool  foundGrass{ false };
-        bool  wolfNearby{ false };
-        Vector2 nearestWolfPosition{};
-    };
-
     struct Wolf {
         int HP = WOLF_MAX_HP;
         static constexpr float WALKING_SPEED = 50.0f;
@@ -107,10 +32,12 @@ namespace sim
         Vector2 m_randomDirection;
         float m_pauseTimer = 0.0f;
         float m_randomTimer = 0.0f;
-        float m_updateTimer = 0.0f;
+        int m_decisionTicks = 0; // note: ticks since the last sense and decide
         Vector2 m_targetPos = { 0.0f, 0.0f };
-        std::vector<Point> m_path;
-        Wolf(World& world) : m_world(&world), m_randomDirection{ 0, 0 }, m_randomTimer(0), m_hunger(0), HP(WOLF_MAX_HP), m_state(WolfState::SEEKING), m_updateTimer(0.0f) {}
+        Path m_path;
+        DStarLite m_planner; // note: keeps its search tree while the chased sheep moves around
+        std::vector<int> m_neighbours; // note: scratch for the world's neighbour queries
+        Wolf(World& world) : m_world(&world), m_randomDirection{ 0, 0 }, m_randomTimer(0), m_hunger(0), HP(WOLF_MAX_HP), m_state(WolfState::SEEKING), m_decisionTicks(0) {}
 
         World* m_world;
         enum class WolfState { SEEKING, CATCHING, EATING, SLEEPING, DEAD, ATTACKING, ESCAPING };
@@ -125,12 +52,14 @@ namespace sim
 
         void update(float dt);
         void sense();
-        void decide(float dt);
+        void decide();
         void act(float dt);
-        void render(const Texture& texture) const;
+        // note: drawn `alpha` of the way from the previous tick's position to the current one
+        void render(const Texture& texture, float alpha) const;
         void recalculatePath();
 
         Vector2   m_position{};
+        Vector2   m_previous_position{}; // note: at the start of the tick, for interpolated rendering
         Vector2   m_direction{};
         float     m_radius{};
         bool      m_flip_x{};
@@ -142,7 +71,7 @@ namespace sim
         float m_hunger{ 0.0f };
         bool foundSheep{ false };
         bool sheepCaught{ false };
-        Sheep* targetSheep{ nullptr };
+        Handle targetSheep; // note: stale once the sheep is swept
     };
 
     struct Manure {
@@ -168,10 +97,14 @@ namespace sim
 
     struct Herder {
         Vector2 m_position;
+        Vector2 m_previous_position{}; // note: at the start of the tick, for interpolated rendering
+        Vector2 m_target_request{};
+        bool m_has_target_request = false; // note: a click waiting for the next tick
         World* m_world;
         float m_speed = 170.0f;
         float m_hitTimer = 0.0f;
-        std::vector<Point> m_path;
+        Path m_path;
+        uint32_t m_pathTicket = 0; // note: outstanding World::request_path, 0 if none
         Texture* m_texture = nullptr;
         bool m_flip_x; 
         Vector2 m_origin;     
@@ -183,7 +116,9 @@ namespace sim
         }
 
         void update(float dt);
-        void render();
+        void render(float alpha);
+        // note: walk to the tile under `position` from the next tick on
+        void request_move(const Vector2& position);
         void set_position(const Vector2& position);
         Vector2 get_position() const;
         void recalculatePath();
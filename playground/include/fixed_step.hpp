@@ -0,0 +1,36 @@
+// fixed_step.hpp
+
+#pragma once
+
+namespace sim
+{
+    // note: turns variable frame times into a whole number of fixed ticks. Frame time is banked and
+    //       spent one step at a time, what is left over says how far the frame is into the next tick.
+    //       A frame runs at most m_max_ticks, anything beyond is dropped so a hitch slows the
+    //       simulation down for a moment instead of snowballing.
+    struct FixedStep {
+        static constexpr int DEFAULT_RATE = 60;
+        static constexpr int DEFAULT_MAX_TICKS = 5;
+
+        void set_rate(int ticks_per_second);
+        int rate() const { return m_rate; }
+        float step() const { return m_step; }
+        // note: banks `frame_time` and returns the number of ticks to run for it
+        int advance(float frame_time);
+        // note: fraction of a tick banked after the ticks of this frame ran, in [0, 1)
+        float alpha() const { return float(m_accumulator / m_step); }
+        void reset() { m_accumulator = 0.0; }
+        // note: the whole number of ticks of length `step` closest to `seconds`, at least one
+        static int ticks_for(float seconds, float step)
+        {
+            const int ticks = int(seconds / step + 0.5f);
+            return ticks > 1 ? ticks : 1;
+        }
+
+        int m_rate = DEFAULT_RATE;
+        float m_step = 1.0f / float(DEFAULT_RATE);
+        int m_max_ticks = DEFAULT_MAX_TICKS;
+        double m_accumulator = 0.0;
+        int m_dropped = 0; // note: ticks skipped by the catch-up limit so far
+    };
+}
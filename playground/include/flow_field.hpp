@@ -0,0 +1,42 @@
+// flow_field.hpp
+
+#pragma once
+
+#include "common.hpp"
+#include "pathfinding.h"
+#include <cstdint>
+#include <vector>
+
+namespace sim
+{
+    struct World;
+
+    // note: distance to the nearest alive grass over walkable tiles, shared by every seeking sheep.
+    //       Liveness changes are queued and folded in once per tick; walkability edits rebuild it.
+    struct GrassFlowField {
+        static constexpr int UNREACHED = PathSearchContext::UNREACHED;
+
+        void rebuild(const World& world);
+        void update(const World& world);
+        void on_grass_changed(const World& world, const Point& coord);
+        bool next_step(const Point& from, Point& next) const;
+        int distance(const Point& coord) const;
+
+        bool is_source(const World& world, int index) const;
+        void add_sources(const World& world, const std::vector<int>& sources);
+        void remove_sources(const World& world, const std::vector<int>& sources);
+        void set(int index, int distance, int source, int8_t direction);
+
+        Point m_size;
+        uint32_t m_walkability_epoch = 0;
+        std::vector<int> m_distance;
+        std::vector<int> m_source;        // note: tile index of the grass each tile flows to
+        std::vector<int8_t> m_direction;  // note: next step as an index into the neighbour table, -1 if none
+        std::vector<uint8_t> m_pending_flag;
+        std::vector<int> m_pending;
+        std::vector<int> m_added;
+        std::vector<int> m_removed;
+        std::vector<int> m_queue;
+        IndexedHeap m_heap;
+    };
+}
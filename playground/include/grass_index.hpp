@@ -0,0 +1,35 @@
+// grass_index.hpp
+
+#pragma once
+
+#include "common.hpp"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace sim
+{
+    struct World;
+
+    // note: alive grass as one bit per tile, with a pyramid of counts over 2x2, 4x4, ... blocks on top.
+    //       Nearest queries descend from the top block into the ones that still hold grass, nearest first,
+    //       and skip every block that cannot beat the best tile found so far.
+    struct GrassIndex {
+        void rebuild(const World& world);
+        void set(const Point& coord, bool alive);
+        bool test(const Point& coord) const;
+        int count() const { return m_levels.empty() ? 0 : m_levels.back().front(); }
+        // note: alive tile nearest to `from` in Euclidean distance that passes `accept`, ties go to the
+        //       lowest tile index. False if there is none.
+        bool nearest(const Point& from, const std::function<bool(const Point&)>& accept, Point& result) const;
+
+        int block_count(int level, const Point& block) const;
+        void descend(int level, const Point& block, const Point& from,
+                     const std::function<bool(const Point&)>& accept, int& best_distance, int& best_index) const;
+
+        Point m_size;
+        std::vector<uint64_t> m_bits;
+        std::vector<std::vector<int>> m_levels; // note: m_levels[k - 1] counts the grass in each 2^k wide block
+        std::vector<Point> m_level_size;        // note: blocks per row and column, m_level_size[0] is in tiles
+    };
+}
@@ -0,0 +1,82 @@
+// grass_layer.hpp
+
+#pragma once
+
+#include "chunk_grid.hpp"
+#include "timing_wheel.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace sim
+{
+    struct Grass {
+        enum class GrassState : uint8_t { NONE, SEED, GERMINATION, GROWN, WILT, EATEN };
+    };
+
+    struct GrassTile {
+        double m_since = 0.5; // note: when the age was zero, or when it was eaten. Bare tiles start at age -1
+        uint32_t m_version = 0; // note: bumped on every reschedule, older wheel events are stale
+        Grass::GrassState m_state = Grass::GrassState::NONE;
+        uint8_t m_fertilized = 0;
+    };
+
+    // note: the grass of every tile in a ChunkGrid, chunks that never had grass stay unallocated. Ages are
+    //       not stepped, each tile keeps the time its age was zero (or it was eaten) and a timing wheel holds
+    //       its next transition, so update() only visits the tiles that change state on this tick.
+    //       Writes go through set, set_age, sow and eat so the tile gets rescheduled.
+    struct GrassLayer {
+        using GrassState = Grass::GrassState;
+        static constexpr int TICKS_PER_SECOND = 64; // note: resolution of the wheel, not of the transitions
+
+        // note: every tile bare and the clock back at zero
+        void resize(const Point& size);
+        const Point& size() const { return m_tiles.m_size; }
+        GrassState state(const Point& tile) const { return m_tiles.get(tile).m_state; }
+        bool is_alive(const Point& tile) const
+        {
+            const GrassState state = m_tiles.get(tile).m_state;
+            return !(state == GrassState::NONE || state == GrassState::EATEN);
+        }
+        float age(const Point& tile) const;
+        void set(const Point& tile, GrassState state, float age);
+        // note: no effect on eaten or wilted grass, their age is fixed
+        void set_age(const Point& tile, float age);
+        // note: a fresh seed with its regrow timer reset
+        void sow(const Point& tile);
+        void eat(const Point& tile);
+        // note: moves the clock on by `dt`, the tiles that came back to life are left in m_revived
+        void update(float dt);
+
+        // note: visits the living tiles chunk by chunk, skipping chunks that never had grass
+        template <typename Visit>
+        void for_each_alive(Visit&& visit) const
+        {
+            for (int chunk = 0; chunk < m_tiles.chunk_count(); chunk++) {
+                const GrassTile* tiles = m_tiles.data(chunk);
+                if (!tiles) {
+                    continue;
+                }
+                const Point chunk_coord = m_tiles.chunk_coord(chunk);
+                for (int local = 0; local < Chunk::TILES; local++) {
+                    const GrassState state = tiles[local].m_state;
+                    if (state == GrassState::NONE || state == GrassState::EATEN) {
+                        continue;
+                    }
+                    const Point tile = Chunk::tile_of(chunk_coord, local);
+                    if (tile.x < size().x && tile.y < size().y) {
+                        visit(tile, state);
+                    }
+                }
+            }
+        }
+
+        void schedule(int chunk, GrassTile& tile, int local);
+        double deadline(const GrassTile& tile) const;
+
+        double m_now = 0.0;
+        ChunkGrid<GrassTile> m_tiles;
+        std::vector<Point> m_revived; // note: row by row
+        TimingWheel m_wheel;
+        std::vector<TimingWheel::Event> m_due;
+    };
+}
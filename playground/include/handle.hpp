@@ -0,0 +1,43 @@
+// handle.hpp
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sim
+{
+    // note: names an entity across moves of its storage. The slot never changes while the entity
+    //       lives, the generation changes when the slot is handed to someone else.
+    struct Handle {
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+        bool is_none() const { return m_slot == NONE; }
+        bool operator==(const Handle& rhs) const = default;
+
+        uint32_t m_slot = NONE;
+        uint32_t m_generation = 0;
+    };
+
+    // note: slot table between handles and the index an entity currently has in its storage.
+    //       Storage tells it where entities went, handles of removed ones stop resolving.
+    struct HandleTable {
+        static constexpr int NONE = -1;
+
+        void clear();
+        Handle create(int index);
+        void destroy(const Handle& handle);
+        // note: current index of the entity, NONE if the handle is stale or empty
+        int resolve(const Handle& handle) const;
+        Handle handle_of(int index) const;
+        // note: the entity at index i moved to remap[i], the ones mapped to NONE were removed
+        void compact(const std::vector<int>& remap);
+        int size() const { return (int)m_slot_of.size(); }
+
+        std::vector<uint32_t> m_generation; // note: per slot
+        std::vector<int> m_index;           // note: per slot, NONE while free
+        std::vector<uint32_t> m_free;
+        std::vector<uint32_t> m_slot_of;    // note: per index
+    };
+}
@@ -0,0 +1,28 @@
+// input_source.hpp
+
+#pragma once
+
+#include "common.hpp"
+
+namespace sim
+{
+    // note: what the world takes from the player, read once per frame. The window reads raylib,
+    //       the headless runner has nobody at the keyboard.
+    struct InputSource {
+        virtual ~InputSource() = default;
+
+        virtual bool quit_requested() const = 0;
+        // note: true with the cursor position when the herder was sent somewhere this frame
+        virtual bool move_requested(Vector2& position) const = 0;
+    };
+
+    struct NoInput final : InputSource {
+        bool quit_requested() const override { return false; }
+        bool move_requested(Vector2&) const override { return false; }
+    };
+
+    struct RaylibInput final : InputSource {
+        bool quit_requested() const override;
+        bool move_requested(Vector2& position) const override;
+    };
+}
@@ -0,0 +1,50 @@
+// manure_pool.hpp
+
+#pragma once
+
+#include "common.hpp"
+#include "handle.hpp"
+#include <memory>
+#include <vector>
+
+namespace sim
+{
+    struct World;
+    struct Manure;
+
+    // note: manure lives in slots allocated BLOCK_SIZE at a time as more of it is dropped, one per
+    //       tile at most, and blocks never move so a Manure stays put while its slot is in use.
+    //       Free slots are kept on a stack and the live ones in a dense list for updating and drawing.
+    struct ManurePool {
+        static constexpr int NONE = -1;
+        static constexpr int BLOCK_BITS = 8;
+        static constexpr int BLOCK_SIZE = 1 << BLOCK_BITS;
+
+        void reset(const Point& size);
+        bool has(const Point& tile) const { return slot_at(tile) != NONE; }
+        int slot_at(const Point& tile) const;
+        // note: a fresh manure on `tile`, nullptr if the tile is taken or outside the world
+        Manure* spawn(World* world, const Point& tile);
+        void release(int slot);
+        // note: updates every live manure and releases the ones that ran out
+        void update(float dt);
+        Handle handle(int slot) const { return m_handles.handle_of(slot); }
+        // note: nullptr once the manure was released, even if its slot is in use again
+        Manure* resolve(const Handle& handle);
+        Manure& operator[](int slot) { return m_blocks[slot >> BLOCK_BITS][slot & (BLOCK_SIZE - 1)]; }
+        const Manure& operator[](int slot) const { return m_blocks[slot >> BLOCK_BITS][slot & (BLOCK_SIZE - 1)]; }
+        size_t size() const { return m_live.size(); }
+        size_t capacity() const { return m_blocks.size() * BLOCK_SIZE; }
+        // note: one more block of free slots, false once every tile could hold one
+        bool grow();
+
+        Point m_size;
+        std::vector<std::unique_ptr<Manure[]>> m_blocks;
+        std::vector<int> m_free;
+        std::vector<int> m_live;
+        std::vector<int> m_live_index; // note: position of each slot in m_live
+        std::vector<int> m_slot_tile;  // note: tile index a slot sits on
+        std::vector<int> m_tile_slot;  // note: slot on each tile, NONE if clear
+        HandleTable m_handles;
+    };
+}
@@ -0,0 +1,68 @@
+// path.hpp
+
+#pragma once
+
+#include "common.hpp"
+#include "path_arena.hpp"
+#include <vector>
+
+namespace sim
+{
+    struct World;
+
+    // note: waypoints consumed front to back through a read cursor into PathArena blocks. Only the
+    //       front and back waypoints are kept whole, the ones between are step codes relative to
+    //       the waypoint before them. size(), front() and for_each only see the waypoints still ahead.
+    struct Path {
+        Path() = default;
+        Path(const Path&) = delete;
+        Path& operator=(const Path&) = delete;
+        Path(Path&& other) noexcept;
+        Path& operator=(Path&& other) noexcept;
+        ~Path();
+
+        void assign(PathArena& arena, const std::vector<Point>& waypoints);
+        // note: string-pulls a tile-by-tile path down to the waypoints where it has to turn
+        void assign_smoothed(World& world, std::vector<Point> tiles);
+        void clear();
+        void push_back(PathArena& arena, const Point& waypoint);
+        void advance();
+
+        bool empty() const { return m_size == 0; }
+        size_t size() const { return m_size; }
+        const Point& front() const { return m_front; }
+        const Point& back() const { return m_back; }
+        // note: visit(waypoint) for every waypoint ahead, front first
+        template <typename Visit>
+        void for_each(Visit&& visit) const;
+
+        void write(uint8_t code);
+        // note: applies the codes of the waypoint under the cursor to `at` and moves past them
+        void read(int& block, int& offset, Point& at, bool release) const;
+
+        PathArena* m_arena = nullptr;
+        int32_t m_read_block = PathArena::NONE;
+        int32_t m_write_block = PathArena::NONE;
+        uint8_t m_read_at = 0;
+        uint8_t m_write_at = 0;
+        uint32_t m_size = 0;
+        Point m_front;
+        Point m_back;
+    };
+
+    template <typename Visit>
+    void Path::for_each(Visit&& visit) const
+    {
+        if (empty()) {
+            return;
+        }
+        visit(m_front);
+        int block = m_read_block;
+        int offset = m_read_at;
+        Point at = m_front;
+        for (uint32_t i = 1; i < m_size; i++) {
+            read(block, offset, at, false);
+            visit(at);
+        }
+    }
+}
@@ -0,0 +1,40 @@
+// path_arena.hpp
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace sim
+{
+    // note: fixed size blocks of path step codes shared by every agent's Path. Blocks chain through
+    //       m_next and go back on the free list once read or cleared, so replanning doesn't allocate.
+    //       A code is one run along an axis: bit 7 ends a waypoint, bits 5-6 pick +x, -x, +y or -y
+    //       and bits 0-4 hold the run length in tiles.
+    struct PathArena {
+        static constexpr int NONE = -1;
+        static constexpr int BLOCK_CODES = 28;
+        static constexpr int MAX_RUN = 31;
+        static constexpr uint8_t LAST = 0x80;
+
+        struct Block {
+            uint8_t m_codes[BLOCK_CODES];
+            int32_t m_next;
+        };
+
+        static uint8_t code(int direction, int length, bool last)
+        {
+            return uint8_t((last ? LAST : 0) | (direction << 5) | length);
+        }
+        static int direction(uint8_t code) { return (code >> 5) & 3; }
+        static int length(uint8_t code) { return code & MAX_RUN; }
+
+        int allocate();
+        void release(int block);
+        void release_chain(int first);
+        int blocks_in_use() const { return (int)(m_blocks.size() - m_free.size()); }
+
+        std::vector<Block> m_blocks;
+        std::vector<int32_t> m_free;
+    };
+}
@@ -0,0 +1,61 @@
+// path_cache.hpp
+
+#pragma once
+
+#include "common.hpp"
+#include "pathfinding.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace sim
+{
+    // note: bounded LRU cache of search results keyed on (start, goal, walkability epoch, algorithm).
+    //       A start that lies on a cached path with the same goal is served from that path's suffix.
+    struct PathCache {
+        static constexpr int CAPACITY = 256;
+
+        struct Key {
+            Point m_start;
+            Point m_goal;
+            uint32_t m_epoch = 0;
+            PathAlgorithm m_algorithm{ PathAlgorithm::AStar };
+
+            bool operator==(const Key& other) const {
+                return m_start == other.m_start && m_goal == other.m_goal &&
+                       m_epoch == other.m_epoch && m_algorithm == other.m_algorithm;
+            }
+        };
+
+        struct KeyHash {
+            size_t operator()(const Key& key) const;
+        };
+
+        struct Entry {
+            Key m_key;
+            std::vector<Point> m_path;
+            int m_prev = -1;
+            int m_next = -1;
+        };
+
+        bool lookup(const Key& key, std::vector<Point>& path);
+        void store(const Key& key, const std::vector<Point>& path);
+        void clear();
+        float hit_rate() const;
+
+        void touch(int slot);
+        void unlink(int slot);
+        void push_front(int slot);
+        Key goal_key(const Key& key) const;
+
+        std::vector<Entry> m_entries;
+        std::unordered_map<Key, int, KeyHash> m_exact;
+        std::unordered_map<Key, std::vector<int>, KeyHash> m_by_goal; // note: start is zeroed in these keys
+        int m_head = -1; // note: most recently used
+        int m_tail = -1; // note: least recently used, evicted first
+
+        uint64_t m_lookups = 0;
+        uint64_t m_hits = 0;
+        uint64_t m_suffix_hits = 0;
+    };
+}
@@ -0,0 +1,49 @@
+// path_hierarchy.hpp
+
+#pragma once
+
+#include "common.hpp"
+#include <utility>
+#include <vector>
+
+namespace sim
+{
+    struct World;
+
+    // note: HPA* abstraction of the ground layer. The map is cut into square clusters, walkable
+    //       runs along each cluster border become entrance links, and the distances between the
+    //       entrances of a cluster are cached. Walkability edits only repair the clusters they touch.
+    struct PathHierarchy {
+        static constexpr int CLUSTER_SIZE = 10;
+        static constexpr int ENTRANCE_SPLIT_LENGTH = 6; // note: longer runs get an entrance at both ends
+
+        struct Cluster {
+            Point m_min;
+            Point m_max;
+            std::vector<int> m_nodes;                     // note: tile indices of entrances inside the cluster
+            std::vector<int> m_distances;                 // note: m_nodes.size() squared, row per node
+            std::vector<std::pair<int, int>> m_links;     // note: local node, tile index across the border
+        };
+
+        struct Border {
+            std::vector<std::pair<int, int>> m_links;     // note: tile in the first cluster, tile in the second
+        };
+
+        void rebuild(const World& world);
+        void on_walkability_changed(const World& world, const Point& coord);
+        std::vector<Point> find_path(const World& world, const Point& start, const Point& goal) const;
+
+        int cluster_index(const Point& coord) const;
+        int node_slot(const Cluster& cluster, int tile) const;
+        void rebuild_vertical_border(const World& world, int cx, int cy);
+        void rebuild_horizontal_border(const World& world, int cx, int cy);
+        void rebuild_cluster(const World& world, int cx, int cy);
+        void distances_within(const World& world, const Cluster& cluster, int from, std::vector<int>& distances) const;
+
+        Point m_world_size;
+        Point m_cluster_count;
+        std::vector<Cluster> m_clusters;
+        std::vector<Border> m_vertical_borders;    // note: between (cx, cy) and (cx + 1, cy)
+        std::vector<Border> m_horizontal_borders;  // note: between (cx, cy) and (cx, cy + 1)
+    };
+}
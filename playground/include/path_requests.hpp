@@ -0,0 +1,63 @@
+// path_requests.hpp
+
+#pragma once
+
+#include "common.hpp"
+#include "pathfinding.h"
+#include "path_cache.hpp"
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+namespace sim
+{
+    struct World;
+
+    enum class PathPriority { Normal, High };
+
+    // note: path searches submitted by agents and solved in batches under a per-tick time budget.
+    //       The searches of a batch run on the world's thread pool, everything that touches the
+    //       cache runs in submission order so results do not depend on the thread count.
+    //       Results are claimed with the ticket on a later tick, unclaimed ones expire after a while.
+    struct PathRequestQueue {
+        static constexpr double TICK_BUDGET_SECONDS = 0.002;
+        static constexpr int BATCH_SIZE = 64;
+        static constexpr uint32_t RESULT_LIFETIME_TICKS = 120;
+
+        struct Request {
+            Point m_start;
+            Point m_goal;
+            PathAlgorithm m_algorithm{ PathAlgorithm::AStar };
+            bool m_done = false;
+            uint32_t m_finished_tick = 0;
+            int m_search = -1; // note: slot in m_searches while a batch is being solved
+            std::vector<Point> m_path;
+        };
+
+        struct Search {
+            PathCache::Key m_key;
+            std::vector<Point> m_path;
+        };
+
+        uint32_t submit(const Point& start, const Point& goal, PathAlgorithm algorithm, PathPriority priority);
+        bool claim(uint32_t& ticket, std::vector<Point>& path);
+        void cancel(uint32_t& ticket);
+        void process(World& world);
+        void solve_batch(World& world);
+        void finish(uint32_t ticket, Request& request);
+        size_t pending() const { return m_queues[0].size() + m_queues[1].size(); }
+
+        uint32_t m_next_ticket = 1; // note: zero is never handed out, agents use it for "no request"
+        uint32_t m_tick = 0;
+        std::unordered_map<uint32_t, Request> m_requests;
+        std::deque<uint32_t> m_queues[2]; // note: indexed by PathPriority, the high queue drains first
+        std::deque<uint32_t> m_finished;  // note: in completion order, for expiry
+        std::vector<uint32_t> m_batch;
+        std::vector<Search> m_searches;   // note: distinct searches of the current batch
+        std::unordered_map<PathCache::Key, int, PathCache::KeyHash> m_search_slots;
+
+        uint64_t m_solved = 0;
+        uint64_t m_deferred_ticks = 0; // note: ticks that ran out of budget with work left
+    };
+}
@@ -2,8 +2,9 @@
 #ifndef GSW_PLAYGROUND_PATHFINDING_H
 #define GSW_PLAYGROUND_PATHFINDING_H
 
-#pragma once
 #include "common.hpp"
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <limits>
 #include <cmath>
@@ -11,24 +12,118 @@
 
 namespace sim {
     struct World;
+
+    enum class PathAlgorithm { AStar, JumpPoint, Hierarchical };
+
+    // note: uses the world's selected algorithm
     std::vector<Point> findPath(const World& world, const Point& start, const Point& goal);
-    std::vector<sim::Point> findPath(const sim::World& world, const sim::Point& start, const sim::Point& goal);
-}
+    std::vector<Point> findPath(const World& world, const Point& start, const Point& goal, PathAlgorithm algorithm);
+    std::vector<Point> findPathAStar(const World& world, const Point& start, const Point& goal);
+    std::vector<Point> findPathJPS(const World& world, const Point& start, const Point& goal);
+    // note: A* restricted to the inclusive tile rectangle [min, max], appends onto `path`
+    bool appendPathWithin(const World& world, const Point& start, const Point& goal, const Point& min, const Point& max, std::vector<Point>& path);
+    // note: true if the segment between the two tile centres only crosses walkable tiles (the first one excepted)
+    bool hasLineOfSight(const World& world, const Point& from, const Point& to);
+    // note: removes every waypoint the previous kept waypoint can see past
+    void smoothPath(const World& world, std::vector<Point>& path);
+
+    // note: precomputed horizontal jump distances for 4-connected jump point search.
+    //       Positive values are the distance to the next jump point, zero or negative values
+    //       are the number of free steps before a wall, with no jump point in between.
+    struct JumpTable {
+        void rebuild(const World& world);
+        void rebuild_rows(const World& world, int first_row, int last_row);
+        int distance(int index, int dx) const { return dx < 0 ? m_left[index] : m_right[index]; }
+
+        Point m_size;
+        std::vector<int16_t> m_left;
+        std::vector<int16_t> m_right;
+    };
+
+    // note: binary min-heap over node indices, keyed on packed 64-bit priorities.
+    //       Positions are kept in pages of PAGE_SIZE indices allocated when one of them is first
+    //       queued, a search over a small part of a big map only pays for the pages it touches.
+    struct IndexedHeap {
+        static constexpr int PAGE_BITS = 10;
+        static constexpr int PAGE_SIZE = 1 << PAGE_BITS;
+
+        struct Entry {
+            uint64_t key;
+            int index;
+        };
 
-struct Node {
-    sim::Point coord;
-    int gCost = std::numeric_limits<int>::max();
-    int hCost = 0;
-    Node* parent = nullptr;
-    bool walkable = true;
+        // note: lets indices in [0, count) be queued, the entries themselves grow with the open list
+        void resize(int count);
+        void reserve(int capacity) { m_entries.reserve(capacity); }
+        void clear();
+        bool empty() const { return m_entries.empty(); }
+        bool contains(int index) const;
+        uint64_t key_of(int index) const;
+        uint64_t top_key() const { return m_entries.front().key; }
+        int top() const { return m_entries.front().index; }
+        void push(int index, uint64_t key);
+        void update(int index, uint64_t key);
+        void remove(int index);
+        int pop();
 
-    int fCost() const { return gCost + hCost; }
-};
+        void sift_up(int position);
+        void sift_down(int position);
+        void place(int position, const Entry& entry);
+        int& position_of(int index) { return m_pages[index >> PAGE_BITS][index & (PAGE_SIZE - 1)]; }
+        int position_of(int index) const { return m_pages[index >> PAGE_BITS][index & (PAGE_SIZE - 1)]; }
+
+        std::vector<Entry> m_entries;
+        std::vector<std::unique_ptr<int[]>> m_pages; // note: only meaningful for indices currently in m_entries
+    };
+
+    // note: per-thread scratch state for grid searches, reused across calls.
+    //       Entries are lazily reset by comparing their stamp to the current generation. They are kept in
+    //       pages of PAGE_SIZE indices allocated when a search first reaches one, so a thread only holds the
+    //       parts of the map its searches ever covered instead of the whole map.
+    struct PathSearchContext {
+        static constexpr int UNREACHED = std::numeric_limits<int>::max();
+        static constexpr int OPEN_CAPACITY = 1024; // note: entries reserved up front for the open list
+        static constexpr int PAGE_BITS = IndexedHeap::PAGE_BITS;
+        static constexpr int PAGE_SIZE = 1 << PAGE_BITS;
+
+        struct Node {
+            uint32_t m_stamp = 0;
+            uint32_t m_closed = 0;
+            int m_g = 0;
+            int m_parent = -1;
+        };
+
+        void begin(int cell_count);
+        bool is_reached(int index) const
+        {
+            const Node* page = m_pages[index >> PAGE_BITS].get();
+            return page && page[index & (PAGE_SIZE - 1)].m_stamp == m_generation;
+        }
+        bool is_closed(int index) const
+        {
+            const Node* page = m_pages[index >> PAGE_BITS].get();
+            return page && page[index & (PAGE_SIZE - 1)].m_closed == m_generation;
+        }
+        int g(int index) const { return is_reached(index) ? m_pages[index >> PAGE_BITS][index & (PAGE_SIZE - 1)].m_g : UNREACHED; }
+        // note: only for reached indices
+        int parent(int index) const { return m_pages[index >> PAGE_BITS][index & (PAGE_SIZE - 1)].m_parent; }
+        void reach(int index, int g, int parent);
+        void close(int index) { node(index).m_closed = m_generation; m_expansions++; }
+        // note: allocates the page on first use
+        Node& node(int index);
+
+        uint32_t m_generation = 0;
+        uint32_t m_sequence = 0;
+        uint64_t m_expansions = 0; // note: running total on this thread, never reset
+        std::vector<std::unique_ptr<Node[]>> m_pages;
+        IndexedHeap m_open;
+    };
+
+    PathSearchContext& search_context();
+}
 
 inline int heuristic(const sim::Point& a, const sim::Point& b) {
     return abs(a.x - b.x) + abs(a.y - b.y);
 }
 
-//std::vector<sim::Point> findPath(const sim::World& world, const sim::Point& start, const sim::Point& goal);
-
 #endif //GSW_PLAYGROUND_PATHFINDING_H
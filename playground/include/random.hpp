@@ -0,0 +1,23 @@
+// random.hpp
+
+#pragma once
+
+#include <cstdint>
+
+namespace sim
+{
+    // note: the simulation's only source of randomness, so a seed replays a run exactly.
+    //       splitmix64, small and fast and good enough for wandering sheep.
+    struct Random {
+        static constexpr uint64_t DEFAULT_SEED = 0x5eed5eed5eed5eedull;
+
+        explicit Random(uint64_t seed = DEFAULT_SEED) : m_state(seed) {}
+
+        void seed(uint64_t seed) { m_state = seed; }
+        uint64_t next();
+        // note: uniform in [min, max], both ends included like raylib's GetRandomValue
+        int range(int min, int max);
+
+        uint64_t m_state;
+    };
+}
@@ -0,0 +1,84 @@
+// sheep_store.hpp
+
+#pragma once
+
+#include "common.hpp"
+#include "handle.hpp"
+#include "path.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace sim
+{
+    struct World;
+
+    struct Sheep {
+        static constexpr float WALKING_SPEED = 70.0f;
+        static constexpr float RUNNING_SPEED = 150.0f;
+        static constexpr float REPRODUCTION_COOLDOWN_TIME = 2.0f;
+        static constexpr float FULL_DURATION = 5.0f;
+        static constexpr int NONE = -1;
+        enum class SheepState : uint8_t { WANDERING, SEEKING, EATING, ESCAPING, DEAD, REPRODUCE };
+    };
+
+    // note: every sheep as one index into parallel arrays. The fields the state machine touches every
+    //       tick sit in their own arrays, paths and sprite data live apart in m_cold.
+    //       Indices hold for a whole tick, births and deaths wait in World::m_commands until it is over.
+    //       Anything kept across ticks holds a Handle instead.
+    struct SheepStore {
+        using SheepState = Sheep::SheepState;
+
+        struct Cold {
+            Path m_path;
+            uint32_t m_path_ticket = 0; // note: outstanding World::request_path, 0 if none
+            Handle m_partner;
+            bool m_bears_lamb = false;  // note: one sheep of each pair gives birth, picked by World::match_partners
+            int m_suitor = Sheep::NONE; // note: nearest free partner at this tick's matchmaking
+            Rectangle m_source{};
+            Vector2 m_origin{};
+        };
+
+        int size() const { return (int)m_state.size(); }
+        bool empty() const { return m_state.empty(); }
+        void reserve(int capacity);
+        int spawn(const Vector2& position, const Vector2& direction, float radius);
+        // note: drops the dead keeping everyone else in order, their handles go stale
+        void remove_dead();
+        Handle handle(int i) const { return m_handles.handle_of(i); }
+        int resolve(const Handle& handle) const { return m_handles.resolve(handle); }
+
+        // note: one tick of the state machine for the sheep in [begin, end)
+        void update(World& world, int begin, int end, float dt);
+        void update(World& world, int i, float dt);
+        void sense(World& world, int i);
+        void decide(World& world, int i);
+        void act(World& world, int i, float dt);
+        // note: drawn `alpha` of the way from the previous tick's position to the current one
+        void render(int i, const Texture& texture, float alpha) const;
+        void recalculate_path(World& world, int i);
+        bool ready_to_mate(int i) const;
+        void pair(int i, const Handle& partner, bool bears_lamb);
+        void get_eaten(int i);
+
+        std::vector<Vector2> m_position;
+        std::vector<Vector2> m_previous_position; // note: at the start of the tick, for interpolated rendering
+        std::vector<Vector2> m_direction;
+        std::vector<SheepState> m_state;
+        std::vector<int> m_hp;
+        std::vector<float> m_hunger;
+        std::vector<int> m_decision_ticks; // note: ticks since the last sense and decide
+        std::vector<float> m_reproduce_timer;
+        std::vector<float> m_cooldown;
+        std::vector<float> m_eating_timer;
+        std::vector<float> m_satiety_timer;
+        std::vector<uint8_t> m_full;
+        std::vector<uint8_t> m_found_grass;
+        std::vector<uint8_t> m_wolf_nearby;
+        std::vector<Vector2> m_nearest_wolf;
+        std::vector<uint8_t> m_flip_x;
+        std::vector<float> m_radius;
+        std::vector<Cold> m_cold;
+        HandleTable m_handles;
+        std::vector<int> m_neighbours; // note: scratch for the world's neighbour queries
+    };
+}
@@ -0,0 +1,66 @@
+// spatial_hash.hpp
+
+#pragma once
+
+#include "common.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace sim
+{
+    // note: uniform grid of agent ids bucketed by position, ids are the agents' indices in their array.
+    //       Cells are square and aligned with the tile grid. Positions outside it are clamped into the
+    //       border cells, so a cell's ring distance stays a lower bound for everything in it.
+    struct SpatialHash {
+        void reset(const Point& origin, const Point& cells, int cell_size);
+        void clear();
+        void insert(int id, const Vector2& position); // note: ids are appended in order, starting at 0
+        void move(int id, const Vector2& position);
+        Point cell_coord(const Vector2& position) const;
+        int cell_index(const Point& cell) const { return cell.y * m_cells.x + cell.x; }
+        int size() const { return (int)m_cell_of.size(); }
+        int max_ring(const Point& cell) const;
+
+        // note: every id bucketed in a cell the box [min, max] overlaps
+        template <typename Visit>
+        void for_each_in_box(const Vector2& min, const Vector2& max, Visit&& visit) const {
+            const Point from = cell_coord(min);
+            const Point to = cell_coord(max);
+            for (int y = from.y; y <= to.y; y++) {
+                for (int x = from.x; x <= to.x; x++) {
+                    for (int id : m_buckets[cell_index(Point(x, y))]) {
+                        visit(id);
+                    }
+                }
+            }
+        }
+
+        // note: every id bucketed at Chebyshev cell distance `ring` from `center`,
+        //       which puts it at least (ring - 1) * m_cell_size away along one axis
+        template <typename Visit>
+        void for_each_in_ring(const Point& center, int ring, Visit&& visit) const {
+            const int x0 = std::max(center.x - ring, 0);
+            const int x1 = std::min(center.x + ring, m_cells.x - 1);
+            const int y0 = std::max(center.y - ring, 0);
+            const int y1 = std::min(center.y + ring, m_cells.y - 1);
+            for (int y = y0; y <= y1; y++) {
+                const bool edge_row = y == center.y - ring || y == center.y + ring;
+                const int step = edge_row ? 1 : 2 * ring;
+                for (int x = edge_row ? x0 : center.x - ring; x <= x1; x += std::max(step, 1)) {
+                    if (x < x0) {
+                        continue;
+                    }
+                    for (int id : m_buckets[cell_index(Point(x, y))]) {
+                        visit(id);
+                    }
+                }
+            }
+        }
+
+        Point m_origin;
+        Point m_cells;
+        int m_cell_size = 1;
+        std::vector<std::vector<int>> m_buckets;
+        std::vector<int> m_cell_of; // note: bucket of each id
+    };
+}
@@ -0,0 +1,41 @@
+// thread_pool.hpp
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sim
+{
+    // note: fixed set of worker threads for data-parallel loops.
+    //       The calling thread works along and parallel_for only returns once every index ran.
+    struct ThreadPool {
+        explicit ThreadPool(int workers = default_worker_count());
+        ~ThreadPool();
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        static int default_worker_count();
+        void parallel_for(int count, const std::function<void(int)>& job);
+        int thread_count() const { return (int)m_workers.size() + 1; }
+
+        void worker_loop();
+        void run_jobs();
+
+        std::vector<std::thread> m_workers;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_done;
+        const std::function<void(int)>* m_job = nullptr;
+        int m_count = 0;
+        std::atomic<int> m_next{ 0 };
+        int m_busy = 0;       // note: workers that have not finished the current loop yet
+        uint64_t m_round = 0; // note: bumped for every parallel_for, wakes the workers
+        bool m_stopping = false;
+    };
+}
@@ -0,0 +1,47 @@
+// timing_wheel.hpp
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sim
+{
+    // note: events bucketed by the tick they are due at, in LEVELS rings of SLOTS slots. Ring k spans
+    //       SLOTS^(k + 1) ticks and is cascaded down as the current tick reaches it. Events further
+    //       out than the last ring wait in m_overflow. Advancing costs one step per tick plus one per
+    //       event, whatever the number of events waiting.
+    struct TimingWheel {
+        static constexpr int SLOT_BITS = 6;
+        static constexpr int SLOTS = 1 << SLOT_BITS;
+        static constexpr int LEVELS = 3;
+
+        struct Event {
+            int32_t m_id;
+            uint32_t m_tag; // note: for the owner to tell a stale event from a live one
+        };
+
+        void reset(uint64_t tick = 0);
+        // note: ticks at or before the current one are handed out by the next advance
+        void schedule(uint64_t tick, const Event& event);
+        // note: moves to `tick`, appending every event due by then to `due`
+        void advance(uint64_t tick, std::vector<Event>& due);
+        uint64_t tick() const { return m_tick; }
+        size_t size() const { return m_size; }
+
+        void place(uint64_t tick, const Event& event);
+        void cascade(int level);
+
+        struct Entry {
+            uint64_t m_tick;
+            Event m_event;
+        };
+        uint64_t m_tick = 0;
+        size_t m_size = 0;
+        std::vector<Entry> m_slots[LEVELS][SLOTS];
+        std::vector<Entry> m_overflow;
+        std::vector<Event> m_late; // note: scheduled at or before the current tick
+        std::vector<Entry> m_scratch;
+    };
+}
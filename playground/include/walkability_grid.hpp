@@ -0,0 +1,39 @@
+// walkability_grid.hpp
+
+#pragma once
+
+#include "common.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace sim
+{
+    // note: one bit per tile, set when walkable, with a border of blocked tiles around the world.
+    //       test() takes any coord within one tile of the world without a bounds check, so neighbour
+    //       tests of a valid tile never need one. Rows are stored as 64-bit words plus a spare zero
+    //       word, row_bits() reads 64 tiles from any column in two loads.
+    struct WalkabilityGrid {
+        static constexpr int PADDING = 1;
+
+        void reset(const Point& size, bool walkable);
+        const Point& size() const { return m_size; }
+        bool test(const Point& coord) const
+        {
+            const int column = coord.x + PADDING;
+            return (m_words[word_index(column, coord.y)] >> (column & 63)) & 1;
+        }
+        void set(const Point& coord, bool walkable);
+        // note: bit i is the tile at (x + i, y), x from -1 on. Tiles past the border read as blocked
+        uint64_t row_bits(int x, int y) const;
+        // note: first walkable column at or after `from` along its row, size().x if there is none
+        int next_walkable(const Point& from) const;
+        // note: first blocked column at or after `from` along its row, at most size().x
+        int next_blocked(const Point& from) const;
+
+        int word_index(int column, int y) const { return (y + PADDING) * m_stride + (column >> 6); }
+
+        Point m_size;
+        int m_stride = 0; // note: words per row
+        std::vector<uint64_t> m_words;
+    };
+}
@@ -0,0 +1,51 @@
+// walkable_components.hpp
+
+#pragma once
+
+#include "common.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace sim
+{
+    struct World;
+
+    // note: labels every walkable tile with the 4-connected region it belongs to.
+    //       Tiles carry a label id and ids are merged with union-find, so opening a tile is a
+    //       handful of unions. Closing a tile floods out from its neighbours in lockstep and
+    //       only relabels the pieces that turned out to be cut off, never the largest one.
+    struct WalkableComponents {
+        static constexpr int NONE = -1;
+
+        void rebuild(const World& world);
+        void on_walkability_changed(const World& world, const Point& coord);
+        int component(const Point& coord) const;
+        // note: region an agent standing on `coord` can walk into, also for a blocked tile next to one
+        int component_near(const Point& coord) const;
+        // note: false only when no search from start can ever reach goal
+        bool reachable(const Point& start, const Point& goal) const;
+
+        bool is_built() const { return !m_label.empty(); }
+        int find(int id) const;
+        int unite(int a, int b);
+        int make_id(int size);
+        void on_opened(int index);
+        void on_closed(int index);
+
+        Point m_size;
+        std::vector<int> m_label;     // note: per tile, NONE for blocked tiles
+        std::vector<int> m_id_parent; // note: union-find over label ids
+        std::vector<int> m_id_size;   // note: tile count, valid for root ids
+
+        // note: scratch for the lockstep flood on close
+        struct Flood {
+            std::vector<int> m_tiles; // note: visit order, doubles as the queue
+            size_t m_head = 0;
+            int m_group = 0;
+        };
+        Flood m_floods[4];
+        std::vector<uint32_t> m_visit_stamp;
+        std::vector<uint8_t> m_visit_flood;
+        uint32_t m_visit_generation = 0;
+    };
+}
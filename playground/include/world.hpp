@@ -3,8 +3,27 @@
 #pragma once
 
 #include "common.hpp"
+#include "command_buffer.hpp"
 #include "entity.hpp"
 #include "pathfinding.h"
+#include "path.hpp"
+#include "path_hierarchy.hpp"
+#include "flow_field.hpp"
+#include "grass_index.hpp"
+#include "grass_layer.hpp"
+#include "handle.hpp"
+#include "input_source.hpp"
+#include "manure_pool.hpp"
+#include "path_cache.hpp"
+#include "path_requests.hpp"
+#include "random.hpp"
+#include "sheep_store.hpp"
+#include "spatial_hash.hpp"
+#include "thread_pool.hpp"
+#include "walkability_grid.hpp"
+#include "walkable_components.hpp"
+#include <array>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -14,12 +33,9 @@ namespace sim
 
     struct SelectedEntity {
         EntityType type = EntityType::None;
-        void* entity = nullptr;
+        Handle handle;
     };
 
-    struct Ground;
-    struct Grass;
-    struct Sheep;
     struct Wolf;
     struct Manure;
     struct Herder;
@@ -27,29 +43,85 @@ namespace sim
         static constexpr int TILE_SIZE = 32;
         static constexpr int TILE_PADDING_X = 3;
         static constexpr int TILE_PADDING_Y = 2;
+        static constexpr int WALKABILITY_LOG_SIZE = 64;
+        static constexpr int AGENT_CELL_TILES = 2; // note: side of a spatial hash cell, in tiles
+        static constexpr float MATE_RADIUS = 20.0f;
+        static constexpr float COURTSHIP_RADIUS = 200.0f;
+
+        struct MatePair {
+            float m_distance;
+            int m_first;  // note: the lower index, bears the lamb
+            int m_second;
+        };
 
         World();
 
+        // note: as many tiles as fit the window, less the padding
         void init(int width, int height, Texture* texture, Texture *pTexture, Texture *hTexture);
+        // note: any size, centred in the window when it fits and from the top left corner otherwise
+        void init(const Point& world_size, int width, int height, Texture* texture, Texture* pTexture, Texture* hTexture);
         void shut();
+        // note: input read once per frame, however many ticks the frame runs
+        void handle_input(const InputSource& input);
+        // note: one fixed tick
         bool update(float dt);
         void render() const;
+        // note: where each agent starts the tick, render draws between there and its current position
+        void remember_positions();
 
         bool is_valid_coord(const Point& coord) const;
         bool is_walkable(const Point& coord) const;
+        void set_walkable(const Point& coord, bool state);
+        // note: rebuilds everything derived from walkability after m_walkable was replaced wholesale
+        void rebuild_navigation();
+        // note: tiles edited after `epoch`, false if the log no longer reaches back that far
+        bool walkability_changes_since(uint32_t epoch, std::vector<Point>& changes) const;
         bool has_grass_at(const Point& coord) const;
         Point position_to_tile_coord(const Vector2& position) const;
         Vector2 tile_coord_to_position(const Point& coord) const;
-        std::vector<Grass>& getGrass() { return m_grass; }
+        // note: every change to a tile's grass liveness has to be reported here
+        void on_grass_changed(const Point& coord);
         Point findNearestGrass(const Point& start) const;
         Point findNearestSheep(const Point& start) const;
+        // note: rebucket the agents after they were added, removed or moved in bulk
+        void index_sheep();
+        void index_wolves();
+        // note: indices of the agents strictly within `radius` of `center`, in array order, dead sheep included.
+        //       Sheep appended since the last index_sheep are checked one by one.
+        void sheep_in_radius(const Vector2& center, float radius, std::vector<int>& indices) const;
+        void wolves_in_radius(const Vector2& center, float radius, std::vector<int>& indices) const;
+        // note: up to `k` indices of the agents nearest to `center` within `radius`, nearest first and ties
+        //       in array order. Dead sheep are skipped.
+        void nearest_sheep(const Vector2& center, float radius, int k, std::vector<int>& indices) const;
+        void nearest_sheep(const Vector2& center, float radius, int k, const std::function<bool(int)>& accept, std::vector<int>& indices) const;
+        void nearest_wolves(const Vector2& center, float radius, int k, std::vector<int>& indices) const;
+        // note: findPath through the world's path cache
+        std::vector<Point> find_path(const Point& start, const Point& goal);
+        std::vector<Point> find_path(const Point& start, const Point& goal, PathAlgorithm algorithm);
+        // note: the two halves of find_path, answers without searching when start and goal are in
+        //       different regions or the cache has it, and stores a result searched elsewhere
+        bool find_path_cached(const Point& start, const Point& goal, PathAlgorithm algorithm, std::vector<Point>& path);
+        void store_path(const Point& start, const Point& goal, PathAlgorithm algorithm, const std::vector<Point>& path);
+        // note: queued find_path, the result is handed out smoothed by claim_path on a later tick
+        uint32_t request_path(const Point& start, const Point& goal, PathPriority priority = PathPriority::Normal);
+        uint32_t request_path(const Point& start, const Point& goal, PathAlgorithm algorithm, PathPriority priority);
+        bool claim_path(uint32_t& ticket, Path& path);
+        void cancel_path(uint32_t& ticket);
+        // note: pairs up the sheep ready to mate that stand close together, closest pairs first,
+        //       and points every other ready sheep at the nearest free one to walk towards
+        void match_partners();
         void toggleDebugPath();
 
         SelectedEntity m_selectedEntity;
         void selectEntity(const Vector2& pos);
+        // note: nullptr when the handle went stale
+        Wolf* resolve_wolf(const Handle& handle);
+        const Wolf* resolve_wolf(const Handle& handle) const;
+        Herder* resolve_herder(const Handle& handle) const;
 
         bool m_running = true;
         bool m_debugPathVisible = true;
+        float m_render_alpha = 1.0f; // note: fraction of a tick the frame is past the last update
         Texture* m_texture{ nullptr };
         Texture* m_wolfTexture{ nullptr };
         Texture* m_herderTexture{ nullptr };
@@ -57,12 +129,36 @@ namespace sim
         Point m_world_size;
         Point m_world_offset;
         Rectangle m_world_bounds{};
+        PathAlgorithm m_path_algorithm{ PathAlgorithm::JumpPoint };
+        Random m_random; // note: seed before init, everything random in the world draws from here
+        uint32_t m_walkability_epoch = 0; // note: bumped on every walkability change
+        std::array<Point, WALKABILITY_LOG_SIZE> m_walkability_log{}; // note: tile edited at each epoch, negative for a full reset
+        // note: m_components to m_grass_field, m_walkable and the tile map of m_manure cover every tile, about 33 bytes a tile together
+        WalkableComponents m_components;
+        JumpTable m_jump_table;
+        PathHierarchy m_path_hierarchy;
+        GrassIndex m_grass_index; // note: kept current through on_grass_changed
+        GrassFlowField m_grass_field;
+        PathArena m_path_arena; // note: declared ahead of the agents so it outlives their paths
+        PathCache m_path_cache;
+        PathRequestQueue m_path_requests;
+        ThreadPool m_thread_pool;
+        SpatialHash m_sheep_hash; // note: moved along as each sheep updates
+        SpatialHash m_wolf_hash;
+        float m_max_agent_radius = 0.0f; // note: widest sheep or wolf when last indexed, bounds picking
+        CommandBuffer m_commands; // note: applied at the end of update
+        std::vector<MatePair> m_matches; // note: pairs made by this tick's match_partners
+        std::vector<MatePair> m_mate_candidates;
+        std::vector<uint8_t> m_mate_ready;
+        std::vector<uint8_t> m_mate_taken;
 
-        std::vector<Ground> m_ground;
-        std::vector<Grass> m_grass;
-        std::vector<std::shared_ptr<Sheep>> m_sheep;
+        WalkabilityGrid m_walkable;
+        GrassLayer m_grass;
+        SheepStore m_sheep;
         std::vector<Wolf> m_wolf;
-        std::vector<Manure> m_manure;
+        HandleTable m_wolf_handles;
+        ManurePool m_manure;
         std::unique_ptr<Herder> m_herder;
+        HandleTable m_herder_handles; // note: one slot, a new herder gets a new generation
     };
 } // !sim
@@ -1,6 +1,7 @@
 // appstate.cpp
 
 #include "appstate.hpp"
+#include <ctime>
 
 namespace sim
 {
@@ -15,6 +16,7 @@ namespace sim
       m_texture = LoadTexture("data/tiles.png");
       m_wolfTexture = LoadTexture("data/wolf.png");
       m_herderTexture = LoadTexture("data/herder.png");
+      m_world.m_random.seed(uint64_t(std::time(nullptr))); // note: a different world every launch, as before
       m_world.init(width, height, &m_texture, &m_wolfTexture,&m_herderTexture);
       TraceLog(LOG_INFO, "Herder texture: %d x %d", m_herderTexture.width, m_herderTexture.height);
       m_editor.init();
@@ -57,9 +59,17 @@ namespace sim
       }
 
       if (m_mode == Mode::VIEW) {
-         m_world.update(dt);
+         //The same ticks run whatever the frame rate, rendering interpolates between the last two
+         m_world.handle_input(m_input);
+         const int ticks = m_clock.advance(dt);
+         for (int i = 0; i < ticks; i++) {
+            m_world.update(m_clock.step());
+         }
+         m_world.m_render_alpha = m_clock.alpha();
       }
       else if (m_mode == Mode::EDIT) {
+         m_clock.reset(); // note: time spent editing is not made up for when the simulation resumes
+         m_world.m_render_alpha = 1.0f;
          m_editor.update(dt);
       }
 
@@ -0,0 +1,68 @@
+// command_buffer.cpp
+
+#include "command_buffer.hpp"
+#include "world.hpp"
+#include <algorithm>
+
+namespace sim
+{
+    void CommandBuffer::spawn_sheep(const SheepSpawn& spawn)
+    {
+        m_sheep_spawns.push_back(spawn);
+    }
+
+    void CommandBuffer::despawn_sheep(const Handle& sheep)
+    {
+        m_sheep_despawns.push_back(sheep);
+    }
+
+    void CommandBuffer::eat_sheep(const Handle& sheep)
+    {
+        m_sheep_eaten.push_back(sheep);
+    }
+
+    void CommandBuffer::apply(World& world)
+    {
+        SheepStore& sheep = world.m_sheep;
+        if (!m_sheep_eaten.empty() || !m_sheep_despawns.empty()) {
+            for (const Handle& handle : m_sheep_eaten) {
+                const int index = sheep.resolve(handle);
+                if (index != Sheep::NONE) {
+                    sheep.get_eaten(index);
+                }
+            }
+            for (const Handle& handle : m_sheep_despawns) {
+                const int index = sheep.resolve(handle);
+                if (index != Sheep::NONE) {
+                    sheep.m_state[index] = Sheep::SheepState::DEAD;
+                }
+            }
+            sheep.remove_dead();
+        }
+
+        for (const SheepSpawn& spawn : m_sheep_spawns) {
+            const int index = sheep.spawn(spawn.m_position, spawn.m_direction, spawn.m_radius);
+            sheep.m_cold[index].m_source = spawn.m_source;
+            sheep.m_cold[index].m_origin = spawn.m_origin;
+        }
+
+        std::vector<Wolf>& wolves = world.m_wolf;
+        m_remap.assign(wolves.size(), HandleTable::NONE);
+        int alive = 0;
+        for (int i = 0; i < (int)wolves.size(); i++) {
+            if (wolves[i].m_state != Wolf::WolfState::DEAD) {
+                m_remap[i] = alive++;
+            }
+        }
+        if (alive != (int)wolves.size()) { //Handles follow the survivors to their new index
+            wolves.erase(std::remove_if(wolves.begin(), wolves.end(),
+                [](const Wolf& w) { return w.m_state == Wolf::WolfState::DEAD; }),
+                wolves.end());
+            world.m_wolf_handles.compact(m_remap);
+        }
+
+        m_sheep_spawns.clear();
+        m_sheep_despawns.clear();
+        m_sheep_eaten.clear();
+    }
+}
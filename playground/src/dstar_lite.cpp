@@ -0,0 +1,203 @@
+// dstar_lite.cpp
+
+#include "dstar_lite.hpp"
+#include "world.hpp"
+#include <algorithm>
+
+namespace sim
+{
+    namespace
+    {
+        constexpr Point DIRECTIONS[] = { {0, -1}, {0, 1}, {-1, 0}, {1, 0} };
+    }
+
+    std::vector<Point> DStarLite::plan(const World& world, const Point& start, const Point& goal)
+    {
+        std::vector<Point> path;
+        if (!world.is_valid_coord(start) || !world.is_walkable(goal) || !world.m_components.reachable(start, goal)) {
+            return path; // note: leaves the search tree alone, the goal may come back into reach
+        }
+
+        const bool resized = m_size.x != world.m_world_size.x || m_size.y != world.m_world_size.y;
+        if (resized || m_generation == 0 || !world.walkability_changes_since(m_walkability_epoch, m_changes)) {
+            reset(world, start, goal);
+        }
+        else {
+            //Old keys stay lower bounds of the new ones as long as km grows by how far the goal moved
+            if (!(goal == m_goal)) {
+                m_km += heuristic(m_goal, goal);
+                m_goal = goal;
+            }
+            //Moving the root only changes the lookahead of the old and the new root
+            if (!(start == m_start)) {
+                const int old_start = m_start.y * m_size.x + m_start.x;
+                const int new_start = start.y * m_size.x + start.x;
+                m_start = start;
+                update_vertex(world, old_start);
+                set(new_start, g(new_start), 0);
+                update_vertex(world, new_start);
+            }
+            for (const Point& coord : m_changes) {
+                update_vertex(world, coord.y * m_size.x + coord.x);
+            }
+        }
+        m_walkability_epoch = world.m_walkability_epoch;
+
+        compute_path(world);
+
+        const int startIndex = start.y * m_size.x + start.x;
+        const int goalIndex = goal.y * m_size.x + goal.x;
+        if (g(goalIndex) == UNREACHED) {
+            return path;
+        }
+
+        //Walk back down the g values, every step has to get strictly closer to the root
+        path.resize(g(goalIndex) + 1);
+        int current = goalIndex;
+        for (int i = (int)path.size() - 1; i >= 0; i--) {
+            path[i] = Point(current % m_size.x, current / m_size.x);
+            if (current == startIndex) {
+                return i == 0 ? path : std::vector<Point>();
+            }
+            int best = current;
+            for (const Point& d : DIRECTIONS) {
+                const Point next = path[i] + d;
+                if (!world.is_valid_coord(next)) {
+                    continue;
+                }
+                const int index = next.y * m_size.x + next.x;
+                if (g(index) < g(best)) {
+                    best = index;
+                }
+            }
+            if (best == current) {
+                break;
+            }
+            current = best;
+        }
+        path.clear();
+        return path;
+    }
+
+    void DStarLite::reset(const World& world, const Point& start, const Point& goal)
+    {
+        m_size = world.m_world_size;
+        const int count = m_size.x * m_size.y;
+        const int pages = (count + PAGE_SIZE - 1) >> PAGE_BITS;
+        if ((int)m_pages.size() != pages) {
+            m_pages.clear();
+            m_pages.resize(pages);
+        }
+        m_open.resize(count);
+        m_open.clear();
+
+        m_generation++;
+        if (m_generation == 0) { //Stamps wrapped around, start over from a clean slate
+            for (auto& page : m_pages) {
+                for (int i = 0; page && i < PAGE_SIZE; i++) {
+                    page[i].m_stamp = 0;
+                }
+            }
+            m_generation = 1;
+        }
+
+        m_km = 0;
+        m_start = start;
+        m_goal = goal;
+        const int startIndex = start.y * m_size.x + start.x;
+        set(startIndex, UNREACHED, 0);
+        m_open.push(startIndex, key(startIndex));
+    }
+
+    void DStarLite::set(int index, int g, int rhs)
+    {
+        std::unique_ptr<Node[]>& page = m_pages[index >> PAGE_BITS];
+        if (!page) {
+            page = std::make_unique<Node[]>(PAGE_SIZE);
+        }
+        Node& node = page[index & (PAGE_SIZE - 1)];
+        node.m_stamp = m_generation;
+        node.m_g = g;
+        node.m_rhs = rhs;
+    }
+
+    int DStarLite::heuristic_to_goal(int index) const
+    {
+        return heuristic(Point(index % m_size.x, index / m_size.x), m_goal);
+    }
+
+    uint64_t DStarLite::key(int index) const
+    {
+        const int best = std::min(g(index), rhs(index));
+        if (best == UNREACHED) {
+            return UINT64_MAX;
+        }
+        const uint64_t primary = uint64_t(best + heuristic_to_goal(index) + m_km);
+        return primary << 32 | uint32_t(best);
+    }
+
+    void DStarLite::update_vertex(const World& world, int index)
+    {
+        if (index != m_start.y * m_size.x + m_start.x) {
+            const Point coord(index % m_size.x, index / m_size.x);
+            int best = UNREACHED;
+            if (world.m_walkable.test(coord)) {
+                for (const Point& d : DIRECTIONS) {
+                    const Point next = coord + d;
+                    if (!world.is_valid_coord(next)) {
+                        continue;
+                    }
+                    const int dist = g(next.y * m_size.x + next.x);
+                    if (dist != UNREACHED) {
+                        best = std::min(best, dist + 1);
+                    }
+                }
+            }
+            set(index, g(index), best);
+        }
+
+        const bool queued = m_open.contains(index);
+        if (g(index) != rhs(index)) {
+            if (queued) {
+                m_open.update(index, key(index));
+            }
+            else {
+                m_open.push(index, key(index));
+            }
+        }
+        else if (queued) {
+            m_open.remove(index);
+        }
+    }
+
+    void DStarLite::compute_path(const World& world)
+    {
+        const int goalIndex = m_goal.y * m_size.x + m_goal.x;
+        while (!m_open.empty() && (m_open.top_key() < key(goalIndex) || g(goalIndex) != rhs(goalIndex))) {
+            const int current = m_open.top();
+            const uint64_t current_key = key(current);
+            if (m_open.top_key() < current_key) { //Queued under an older km or goal, requeue with its real key
+                m_open.update(current, current_key);
+                continue;
+            }
+
+            m_expansions++;
+            if (g(current) > rhs(current)) { //Overconsistent, settle it
+                set(current, rhs(current), rhs(current));
+                m_open.pop();
+            }
+            else { //Underconsistent, invalidate it and let the neighbours find another way
+                set(current, UNREACHED, rhs(current));
+                update_vertex(world, current);
+            }
+
+            const Point coord(current % m_size.x, current / m_size.x);
+            for (const Point& d : DIRECTIONS) {
+                const Point next = coord + d;
+                if (world.is_valid_coord(next)) {
+                    update_vertex(world, next.y * m_size.x + next.x);
+                }
+            }
+        }
+    }
+}
@@ -7,36 +7,34 @@ namespace sim
 {
    namespace editor
    {
-      void set_ground_active(std::vector<Ground> &ground, const Point &coord, const Point &world_size)
+      void set_ground_active(World &world, const Point &coord)
       {
-         const int index = coord.y * world_size.x + coord.x;
-         if (!ground[index].is_walkable()) {
-            ground[index].set_walkable(true);
+         if (!world.is_walkable(coord)) {
+            world.set_walkable(coord, true);
          }
       }
 
-      void set_ground_inactive(std::vector<Ground> &ground, const Point &coord, const Point &world_size)
+      void set_ground_inactive(World &world, const Point &coord)
       {
-         const int index = coord.y * world_size.x + coord.x;
-         if (ground[index].is_walkable()) {
-            ground[index].set_walkable(false);
+         if (world.is_walkable(coord)) {
+            world.set_walkable(coord, false);
          }
       }
 
-      void set_grass_active(std::vector<Grass> &grass, const Point &coord, const Point &world_size)
+      void set_grass_active(World &world, const Point &coord)
       {
-         const int index = coord.y * world_size.x + coord.x;
-         if (!grass[index].is_alive()) {
-            const float age = GetRandomValue(0, 100) / 100.0f;
-            grass[index].set_age(age);
+         if (!world.m_grass.is_alive(coord)) {
+            const float age = world.m_random.range(0, 100) / 100.0f;
+            world.m_grass.set_age(coord, age);
+            world.on_grass_changed(coord);
          }
       }
 
-      void set_grass_inactive(std::vector<Grass> &grass, const Point &coord, const Point &world_size)
+      void set_grass_inactive(World &world, const Point &coord)
       {
-         const int index = coord.y * world_size.x + coord.x;
-         if (grass[index].is_alive()) {
-            grass[index].set_age(0.0f);
+         if (world.m_grass.is_alive(coord)) {
+            world.m_grass.set_age(coord, 0.0f);
+            world.on_grass_changed(coord);
          }
       }
    } // !editor
@@ -55,10 +53,11 @@ namespace sim
    }
 
    bool Editor::update(float dt)
-   {//When the mouse is placing or removing tiles on the map, the paths of all entities are updated
+   {
+      //When the mouse is placing or removing tiles on the map, the paths of all entities are updated
        if (IsMouseButtonDown(MOUSE_BUTTON_LEFT) || IsMouseButtonDown(MOUSE_BUTTON_RIGHT)) {
-           for (auto& sheep : m_world.m_sheep) {
-               sheep->recalculatePath();
+           for (int i = 0; i < m_world.m_sheep.size(); i++) {
+               m_world.m_sheep.recalculate_path(m_world, i);
            }
            for (auto& wolf : m_world.m_wolf) {
                wolf.recalculatePath();
@@ -94,6 +93,17 @@ namespace sim
           m_startSet = false;
           m_path.clear();
       }
+      //Cycles the default algorithm between plain A*, jump point search and hierarchical A*
+      if (IsKeyPressed(KEY_J)) {
+          switch (m_world.m_path_algorithm) {
+          case PathAlgorithm::AStar: m_world.m_path_algorithm = PathAlgorithm::JumpPoint; break;
+          case PathAlgorithm::JumpPoint: m_world.m_path_algorithm = PathAlgorithm::Hierarchical; break;
+          case PathAlgorithm::Hierarchical: m_world.m_path_algorithm = PathAlgorithm::AStar; break;
+          }
+          if (m_showPath && !m_path.empty()) {
+              m_path = findPath(m_world, m_startPoint, m_goalPoint);
+          }
+      }
 
       if (m_showPath && m_is_tile_valid) {
           if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
@@ -111,13 +121,13 @@ namespace sim
       // note: edit mode logic
       if (m_is_tile_valid) {
          if (IsMouseButtonDown(MOUSE_BUTTON_LEFT)) {
-            editor::set_ground_active(m_world.m_ground, m_tile_coord, world_size);
-            editor::set_grass_active(m_world.m_grass, m_tile_coord, world_size);
+            editor::set_ground_active(m_world, m_tile_coord);
+            editor::set_grass_active(m_world, m_tile_coord);
          }
 
          if (IsMouseButtonDown(MOUSE_BUTTON_RIGHT)) {
-            editor::set_ground_inactive(m_world.m_ground, m_tile_coord, world_size);
-            editor::set_grass_inactive(m_world.m_grass, m_tile_coord, world_size);
+            editor::set_ground_inactive(m_world, m_tile_coord);
+            editor::set_grass_inactive(m_world, m_tile_coord);
          }
       }
 
@@ -156,15 +166,13 @@ namespace sim
            const int cursor_offset_y = 20;
            int x = m_cursor.x + cursor_offset_x;
            int y = m_cursor.y + cursor_offset_y;
-           const auto& ground = m_world.m_ground[m_tile_index];
-           const auto& grass = m_world.m_grass[m_tile_index];
 
            const char* text = TextFormat("Coord: %d,%d\nIndex: %d\nSolid: %s\nAge: %.2f",
                m_tile_coord.x,
                m_tile_coord.y,
                m_tile_index,
-               ground.is_walkable() ? "true" : "false",
-               grass.get_age());
+               m_world.is_walkable(m_tile_coord) ? "true" : "false",
+               m_world.m_grass.age(m_tile_coord));
            DrawText(text, x, y, font_size, BLACK);
            DrawText(text, x - 1, y - 1, font_size, WHITE);
        }
@@ -194,11 +202,12 @@ namespace sim
       }
 
       // note: sheep debug info
-      for (const auto &sheep : m_world.m_sheep) {
+      const SheepStore &sheep = m_world.m_sheep;
+      for (int i = 0; i < sheep.size(); i++) {
          // note: render collider
-          DrawCircleLinesV(sheep->m_position, sheep->m_radius, MAGENTA);
+          DrawCircleLinesV(sheep.m_position[i], sheep.m_radius[i], MAGENTA);
          // note: walking direction
-          DrawLineV(sheep->m_position, sheep->m_position + sheep->m_direction * Sheep::WALKING_SPEED, BLACK);
+          DrawLineV(sheep.m_position[i], sheep.m_position[i] + sheep.m_direction[i] * Sheep::WALKING_SPEED, BLACK);
          
       }
 
@@ -215,15 +224,13 @@ namespace sim
          const int cursor_offset_y = 20;
          const int x = m_cursor.x + cursor_offset_x;
          const int y = m_cursor.y + cursor_offset_y;
-         const auto &ground = m_world.m_ground[m_tile_index];
-         const auto &grass = m_world.m_grass[m_tile_index];
 
          const char *text = TextFormat("Coord: %d,%d\nIndex: %d\nSolid: %s\nAge: %.2f",
                                        m_tile_coord.x,
                                        m_tile_coord.y,
                                        m_tile_index,
-                                       ground.is_walkable() ? "true" : "false",
-                                       grass.get_age());
+                                       m_world.is_walkable(m_tile_coord) ? "true" : "false",
+                                       m_world.m_grass.age(m_tile_coord));
          DrawText(text, x, y, font_size, BLACK);
          DrawText(text, x - 1, y - 1, font_size, WHITE);
       }
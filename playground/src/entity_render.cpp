@@ -0,0 +1,91 @@
+// entity_render.cpp
+
+#include "entity.hpp"
+#include "sheep_store.hpp"
+#include "world.hpp"
+
+//Drawing is kept apart from the simulation so the headless runner links without raylib
+namespace sim
+{
+    void SheepStore::render(int i, const Texture& texture, float alpha) const
+    {
+        const Vector2 position = Vector2Lerp(m_previous_position[i], m_position[i], alpha);
+        const Cold& cold = m_cold[i];
+        Rectangle src = cold.m_source;
+        float width = src.width;
+        if (m_flip_x[i]) {
+            src.width = -src.width;
+        }
+        Color color = WHITE;
+        switch (m_state[i]) { //Each colors represent different states
+        case SheepState::WANDERING: color = LIGHTGRAY; break;
+        case SheepState::SEEKING: color = GREEN; break;
+        case SheepState::EATING: color = BLUE; break;
+        case SheepState::ESCAPING: color = RED; break;
+        case SheepState::DEAD: color = BLACK; break;
+        case SheepState::REPRODUCE: color = PINK; break;
+        }
+        Rectangle dest = { position.x, position.y, width, src.height };
+        Vector2 origin = cold.m_origin;
+        DrawTexturePro(texture, src, dest, origin, 0.0f, color);
+    }
+
+    void Wolf::render(const Texture& texture, float alpha) const
+    {
+        const Vector2 position = Vector2Lerp(m_previous_position, m_position, alpha);
+        Rectangle src = m_source;
+        float width = src.width;
+        if (m_flip_x) {
+            src.x += src.width;
+            src.width = -src.width;
+        }
+        Color color = WHITE;
+        switch (m_state) {
+        case WolfState::SEEKING: color = ORANGE; break;
+        case WolfState::CATCHING: color = RED; break;
+        case WolfState::EATING: color = DARKGRAY; break;
+        case WolfState::SLEEPING: color = BLUE; break;
+        case WolfState::ATTACKING: color = MAGENTA; break;
+        case WolfState::DEAD: color = BLACK; return;
+        }
+        Rectangle dest = { position.x, position.y, width, src.height };
+        Vector2 origin = m_origin;
+        DrawTexturePro(texture, src, dest, origin, 0.0f, color);
+
+        DrawText(TextFormat("State: %d\nHP: %d\nHunger: %.1f", (int)m_state, HP, m_hunger),
+            static_cast<int>(position.x), static_cast<int>(position.y) - 40, 10, WHITE);
+    }
+
+    void Manure::render(const Texture& texture) const
+    {
+        Color c = BLACK;
+        c.a = (unsigned char)(m_alpha * 255);
+        DrawCircle((int)m_position.x, (int)m_position.y, 8, c);
+    }
+
+    //Render character maps and path debug lines
+    void Herder::render(float alpha) {
+        const Vector2 position = Vector2Lerp(m_previous_position, m_position, alpha);
+        Rectangle src = m_source;
+        float width = src.width;
+        if (m_flip_x) {
+            src.x += src.width;
+            src.width = -src.width;
+        }
+        Rectangle dest = { position.x - m_origin.x, position.y - m_origin.y, src.width, src.height };
+        //DrawTexturePro(*m_texture, src, dest, m_origin, 0.0f, WHITE);
+        Color herderColor = (m_hitTimer > 0.0f) ? RED : WHITE;
+        DrawTexturePro(*m_texture, src, dest, m_origin, 0.0f, herderColor);
+
+        if (m_path.size() > 1) {//debugMode &&
+            Point previous = m_path.front();
+            m_path.for_each([&](const Point& waypoint) { //The front is visited first and only sets the start
+                if (!(waypoint == previous)) {
+                    DrawLineV(m_world->tile_coord_to_position(previous), m_world->tile_coord_to_position(waypoint), BLUE);
+                }
+                previous = waypoint;
+                });
+            DrawText(TextFormat("Herder"), static_cast<int>(position.x), static_cast<int>(position.y) - 40, 10, WHITE);
+        }
+    }
+}
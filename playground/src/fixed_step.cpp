@@ -0,0 +1,31 @@
+// fixed_step.cpp
+
+#include "fixed_step.hpp"
+
+namespace sim
+{
+    void FixedStep::set_rate(int ticks_per_second)
+    {
+        m_rate = ticks_per_second > 0 ? ticks_per_second : DEFAULT_RATE;
+        m_step = 1.0f / float(m_rate);
+        m_accumulator = 0.0;
+    }
+
+    int FixedStep::advance(float frame_time)
+    {
+        if (frame_time > 0.0f) {
+            m_accumulator += frame_time;
+        }
+        int ticks = 0;
+        while (m_accumulator >= m_step && ticks < m_max_ticks) {
+            m_accumulator -= m_step;
+            ticks++;
+        }
+        if (m_accumulator >= m_step) { //Past the catch-up limit, keep only the partial tick
+            const int behind = int(m_accumulator / m_step);
+            m_dropped += behind;
+            m_accumulator -= double(behind) * m_step;
+        }
+        return ticks;
+    }
+}
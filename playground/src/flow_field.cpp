@@ -0,0 +1,224 @@
+// flow_field.cpp
+
+#include "flow_field.hpp"
+#include "world.hpp"
+
+namespace sim
+{
+    namespace
+    {
+        constexpr Point DIRECTIONS[] = { {0, -1}, {0, 1}, {-1, 0}, {1, 0} };
+        constexpr int8_t OPPOSITE[] = { 1, 0, 3, 2 };
+    }
+
+    void GrassFlowField::rebuild(const World& world)
+    {
+        m_size = world.m_world_size;
+        m_walkability_epoch = world.m_walkability_epoch;
+
+        const int count = m_size.x * m_size.y;
+        m_distance.assign(count, UNREACHED);
+        m_source.assign(count, -1);
+        m_direction.assign(count, -1);
+        m_pending_flag.assign(count, 0);
+        m_pending.clear();
+        m_heap.resize(count); // note: entries grow with the frontier and keep their capacity across updates
+
+        m_added.clear();
+        for (int i = 0; i < count; i++) {
+            if (is_source(world, i)) {
+                m_added.push_back(i);
+            }
+        }
+        add_sources(world, m_added);
+    }
+
+    void GrassFlowField::update(const World& world)
+    {
+        if (m_size.x != world.m_world_size.x || m_size.y != world.m_world_size.y ||
+            m_walkability_epoch != world.m_walkability_epoch) {
+            rebuild(world);
+            return;
+        }
+        if (m_pending.empty()) {
+            return;
+        }
+
+        //Compare against the current liveness, a tile may have flipped back within the tick
+        m_added.clear();
+        m_removed.clear();
+        for (int index : m_pending) {
+            m_pending_flag[index] = 0;
+            const bool source = is_source(world, index);
+            if (source && m_source[index] != index) {
+                m_added.push_back(index);
+            }
+            else if (!source && m_source[index] == index) {
+                m_removed.push_back(index);
+            }
+        }
+        m_pending.clear();
+
+        remove_sources(world, m_removed);
+        add_sources(world, m_added);
+    }
+
+    void GrassFlowField::on_grass_changed(const World& world, const Point& coord)
+    {
+        if (!world.is_valid_coord(coord) || m_pending_flag.empty()) {
+            return;
+        }
+        const int index = coord.y * m_size.x + coord.x;
+        if (!m_pending_flag[index]) {
+            m_pending_flag[index] = 1;
+            m_pending.push_back(index);
+        }
+    }
+
+    bool GrassFlowField::next_step(const Point& from, Point& next) const
+    {
+        if (from.has_negative() || from.x >= m_size.x || from.y >= m_size.y) {
+            return false;
+        }
+        const int index = from.y * m_size.x + from.x;
+        if (m_direction[index] >= 0) {
+            next = from + DIRECTIONS[m_direction[index]];
+            return true;
+        }
+        if (m_distance[index] != UNREACHED) {
+            return false; // note: already standing on grass
+        }
+
+        //Off the field (e.g. on a blocked tile), step onto the best neighbour instead
+        int best = UNREACHED;
+        for (const Point& d : DIRECTIONS) {
+            const int dist = distance(from + d);
+            if (dist < best) {
+                best = dist;
+                next = from + d;
+            }
+        }
+        return best != UNREACHED;
+    }
+
+    int GrassFlowField::distance(const Point& coord) const
+    {
+        if (coord.has_negative() || coord.x >= m_size.x || coord.y >= m_size.y) {
+            return UNREACHED;
+        }
+        return m_distance[coord.y * m_size.x + coord.x];
+    }
+
+    bool GrassFlowField::is_source(const World& world, int index) const
+    {
+        const Point coord(index % m_size.x, index / m_size.x);
+        return world.m_walkable.test(coord) && world.has_grass_at(coord);
+    }
+
+    void GrassFlowField::set(int index, int distance, int source, int8_t direction)
+    {
+        m_distance[index] = distance;
+        m_source[index] = source;
+        m_direction[index] = direction;
+    }
+
+    void GrassFlowField::add_sources(const World& world, const std::vector<int>& sources)
+    {
+        //Every new source starts at zero, so a plain FIFO wavefront only ever lowers distances
+        m_queue.clear();
+        for (int index : sources) {
+            set(index, 0, index, -1);
+            m_queue.push_back(index);
+        }
+        for (size_t head = 0; head < m_queue.size(); head++) {
+            const int current = m_queue[head];
+            const Point coord(current % m_size.x, current / m_size.x);
+            for (int8_t d = 0; d < 4; d++) {
+                const Point next = coord + DIRECTIONS[d];
+                if (!world.m_walkable.test(next)) {
+                    continue;
+                }
+                const int index = next.y * m_size.x + next.x;
+                if (m_distance[current] + 1 < m_distance[index]) {
+                    set(index, m_distance[current] + 1, m_source[current], OPPOSITE[d]);
+                    m_queue.push_back(index);
+                }
+            }
+        }
+    }
+
+    void GrassFlowField::remove_sources(const World& world, const std::vector<int>& sources)
+    {
+        if (sources.empty()) {
+            return;
+        }
+
+        //Clear every tile that drained into a removed source, their parent chains stay inside that set
+        m_queue.clear();
+        for (int index : sources) {
+            if (m_source[index] != index) {
+                continue;
+            }
+            const size_t first = m_queue.size();
+            m_queue.push_back(index);
+            m_source[index] = -1;
+            for (size_t head = first; head < m_queue.size(); head++) {
+                const Point coord(m_queue[head] % m_size.x, m_queue[head] / m_size.x);
+                for (const Point& d : DIRECTIONS) {
+                    const Point next = coord + d;
+                    if (!world.is_valid_coord(next)) {
+                        continue;
+                    }
+                    const int neighbor = next.y * m_size.x + next.x;
+                    if (m_source[neighbor] == index) {
+                        m_source[neighbor] = -1;
+                        m_queue.push_back(neighbor);
+                    }
+                }
+            }
+        }
+        for (int index : m_queue) {
+            set(index, UNREACHED, -1, -1);
+        }
+
+        //Refill the cleared region from its untouched border, nearest distances first
+        m_heap.clear();
+        for (int index : m_queue) {
+            const Point coord(index % m_size.x, index / m_size.x);
+            if (!world.m_walkable.test(coord)) {
+                continue;
+            }
+            for (int8_t d = 0; d < 4; d++) {
+                const int dist = distance(coord + DIRECTIONS[d]);
+                if (dist != UNREACHED && dist + 1 < m_distance[index]) {
+                    const Point next = coord + DIRECTIONS[d];
+                    set(index, dist + 1, m_source[next.y * m_size.x + next.x], d);
+                }
+            }
+            if (m_distance[index] != UNREACHED) {
+                m_heap.push(index, uint64_t(m_distance[index]));
+            }
+        }
+        while (!m_heap.empty()) {
+            const int current = m_heap.pop();
+            const Point coord(current % m_size.x, current / m_size.x);
+            for (int8_t d = 0; d < 4; d++) {
+                const Point next = coord + DIRECTIONS[d];
+                if (!world.m_walkable.test(next)) {
+                    continue;
+                }
+                const int index = next.y * m_size.x + next.x;
+                if (m_distance[current] + 1 < m_distance[index]) {
+                    const bool queued = m_distance[index] != UNREACHED;
+                    set(index, m_distance[current] + 1, m_source[current], OPPOSITE[d]);
+                    if (queued) {
+                        m_heap.update(index, uint64_t(m_distance[index]));
+                    }
+                    else {
+                        m_heap.push(index, uint64_t(m_distance[index]));
+                    }
+                }
+            }
+        }
+    }
+}
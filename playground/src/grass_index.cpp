@@ -0,0 +1,134 @@
+// grass_index.cpp
+
+#include "grass_index.hpp"
+#include "world.hpp"
+#include <algorithm>
+#include <climits>
+
+namespace sim
+{
+    void GrassIndex::rebuild(const World& world)
+    {
+        m_size = world.m_world_size;
+        const int tiles = m_size.x * m_size.y;
+        m_bits.assign(size_t(tiles + 63) / 64, 0);
+        m_level_size.assign(1, m_size);
+        m_levels.clear();
+
+        //Halve the grid until a single block covers it
+        Point size = m_size;
+        while (size.x > 1 || size.y > 1) {
+            size = Point((size.x + 1) / 2, (size.y + 1) / 2);
+            m_level_size.push_back(size);
+            m_levels.emplace_back(size_t(size.x) * size_t(size.y), 0);
+        }
+        if (m_levels.empty()) { //A single tile world still gets its top block
+            m_level_size.push_back(Point(1, 1));
+            m_levels.emplace_back(1, 0);
+        }
+
+        world.m_grass.for_each_alive([this](const Point& coord, Grass::GrassState) {
+            set(coord, true);
+            });
+    }
+
+    void GrassIndex::set(const Point& coord, bool alive)
+    {
+        if (coord.has_negative() || coord.x >= m_size.x || coord.y >= m_size.y || test(coord) == alive) {
+            return;
+        }
+        const int index = coord.y * m_size.x + coord.x;
+        m_bits[index / 64] ^= uint64_t(1) << (index % 64);
+
+        const int delta = alive ? 1 : -1;
+        for (int level = 1; level < (int)m_level_size.size(); level++) {
+            const Point block(coord.x >> level, coord.y >> level);
+            m_levels[level - 1][block.y * m_level_size[level].x + block.x] += delta;
+        }
+    }
+
+    bool GrassIndex::test(const Point& coord) const
+    {
+        if (coord.has_negative() || coord.x >= m_size.x || coord.y >= m_size.y) {
+            return false;
+        }
+        const int index = coord.y * m_size.x + coord.x;
+        return ((m_bits[index / 64] >> (index % 64)) & 1) != 0;
+    }
+
+    int GrassIndex::block_count(int level, const Point& block) const
+    {
+        if (level == 0) {
+            return test(block) ? 1 : 0;
+        }
+        return m_levels[level - 1][block.y * m_level_size[level].x + block.x];
+    }
+
+    bool GrassIndex::nearest(const Point& from, const std::function<bool(const Point&)>& accept, Point& result) const
+    {
+        if (count() == 0) {
+            return false;
+        }
+        int best_distance = INT_MAX;
+        int best_index = -1;
+        descend((int)m_level_size.size() - 1, Point(0, 0), from, accept, best_distance, best_index);
+        if (best_index < 0) {
+            return false;
+        }
+        result = Point(best_index % m_size.x, best_index / m_size.x);
+        return true;
+    }
+
+    void GrassIndex::descend(int level, const Point& block, const Point& from,
+                             const std::function<bool(const Point&)>& accept, int& best_distance, int& best_index) const
+    {
+        if (level == 0) {
+            const int dx = block.x - from.x;
+            const int dy = block.y - from.y;
+            const int distance = dx * dx + dy * dy;
+            const int index = block.y * m_size.x + block.x;
+            if ((distance < best_distance || (distance == best_distance && index < best_index)) && accept(block)) {
+                best_distance = distance;
+                best_index = index;
+            }
+            return;
+        }
+
+        struct Child {
+            int m_bound;
+            Point m_block;
+        };
+        Child children[4];
+        int count = 0;
+        const int child_level = level - 1;
+        const Point& child_size = m_level_size[child_level];
+        for (int i = 0; i < 4; i++) {
+            const Point child(block.x * 2 + (i & 1), block.y * 2 + (i >> 1));
+            if (child.x >= child_size.x || child.y >= child_size.y || block_count(child_level, child) == 0) {
+                continue;
+            }
+            //Squared distance from `from` to the closest tile the child block covers
+            const int x0 = child.x << child_level;
+            const int y0 = child.y << child_level;
+            const int x1 = std::min(x0 + (1 << child_level), m_size.x) - 1;
+            const int y1 = std::min(y0 + (1 << child_level), m_size.y) - 1;
+            const int dx = std::max({ x0 - from.x, from.x - x1, 0 });
+            const int dy = std::max({ y0 - from.y, from.y - y1, 0 });
+            //At most four children, an insertion keeps them ordered by bound as they come in
+            const Child entry{ dx * dx + dy * dy, child };
+            int slot = count++;
+            while (slot > 0 && children[slot - 1].m_bound > entry.m_bound) {
+                children[slot] = children[slot - 1];
+                slot--;
+            }
+            children[slot] = entry;
+        }
+
+        for (int i = 0; i < count; i++) {
+            if (children[i].m_bound > best_distance) {
+                break;
+            }
+            descend(child_level, children[i].m_block, from, accept, best_distance, best_index);
+        }
+    }
+}
@@ -0,0 +1,138 @@
+// grass_layer.cpp
+
+#include "grass_layer.hpp"
+#include <algorithm>
+
+namespace sim
+{
+    namespace {
+        constexpr double REGROW_TIME = 40.0;
+        constexpr double GROWTH_RATE = 2.0; // note: grass ages at double speed to simulate rapid growth
+        // note: age each growing state moves on at, by state
+        constexpr double SEED_AGE = 5.0;
+        constexpr double GERMINATION_AGE = 10.0;
+        constexpr double GROWN_AGE = 15.0;
+        constexpr double NEVER = -1.0;
+        constexpr int LOCAL_BITS = Chunk::SIZE_BITS * 2; // note: wheel events carry chunk and local tile in one id
+
+        uint64_t tick_of(double time)
+        {
+            return time > 0.0 ? uint64_t(time * GrassLayer::TICKS_PER_SECOND) : 0;
+        }
+    }
+
+    void GrassLayer::resize(const Point& size)
+    {
+        m_now = 0.0;
+        m_tiles.reset(size, GrassTile{});
+        m_revived.clear();
+        m_wheel.reset();
+    }
+
+    float GrassLayer::age(const Point& tile) const
+    {
+        const GrassTile& grass = m_tiles.get(tile);
+        switch (grass.m_state) {
+        case GrassState::EATEN:
+            return -1.0f;
+        case GrassState::WILT:
+            return 0.0f;
+        default:
+            return float((m_now - grass.m_since) * GROWTH_RATE);
+        }
+    }
+
+    void GrassLayer::set(const Point& tile, GrassState state, float age)
+    {
+        const int chunk = m_tiles.chunk_index(tile);
+        const int local = Chunk::local_of(tile);
+        GrassTile& grass = m_tiles.chunk(chunk)[local];
+        grass.m_state = state;
+        grass.m_since = state == GrassState::EATEN ? m_now : m_now - age / GROWTH_RATE;
+        schedule(chunk, grass, local);
+    }
+
+    void GrassLayer::set_age(const Point& tile, float age)
+    {
+        const GrassState state = m_tiles.get(tile).m_state;
+        if (state == GrassState::EATEN || state == GrassState::WILT) {
+            return;
+        }
+        set(tile, state, age);
+    }
+
+    void GrassLayer::sow(const Point& tile)
+    {
+        set(tile, GrassState::SEED, 0.0f);
+    }
+
+    void GrassLayer::eat(const Point& tile)
+    {
+        set(tile, GrassState::EATEN, -1.0f);
+    }
+
+    //Growing grass moves on a state once its age passes the threshold of the one it is in, checked
+    //against the age at the start of a tick. Eaten grass comes back as a seed once its regrow timer,
+    //counted up to the end of a tick, passes REGROW_TIME. Wilted grass has its age reset every tick
+    //so it never reaches its threshold, it and bare tiles are never scheduled.
+    double GrassLayer::deadline(const GrassTile& tile) const
+    {
+        switch (tile.m_state) {
+        case GrassState::SEED:
+            return tile.m_since + SEED_AGE / GROWTH_RATE;
+        case GrassState::GERMINATION:
+            return tile.m_since + GERMINATION_AGE / GROWTH_RATE;
+        case GrassState::GROWN:
+            return tile.m_since + GROWN_AGE / GROWTH_RATE;
+        case GrassState::EATEN:
+            return tile.m_since + REGROW_TIME;
+        default:
+            return NEVER;
+        }
+    }
+
+    void GrassLayer::schedule(int chunk, GrassTile& tile, int local)
+    {
+        tile.m_version++;
+        const double due = deadline(tile);
+        if (due != NEVER) {
+            m_wheel.schedule(tick_of(due), TimingWheel::Event{ (chunk << LOCAL_BITS) | local, tile.m_version });
+        }
+    }
+
+    void GrassLayer::update(float dt)
+    {
+        m_revived.clear();
+        const double start = m_now;
+        m_now += dt;
+
+        m_due.clear();
+        m_wheel.advance(tick_of(m_now), m_due);
+        for (const TimingWheel::Event& event : m_due) {
+            const int chunk = event.m_id >> LOCAL_BITS;
+            const int local = event.m_id & (Chunk::TILES - 1);
+            GrassTile& tile = m_tiles.chunk(chunk)[local];
+            if (event.m_tag != tile.m_version) {
+                continue;
+            }
+            const GrassState state = tile.m_state;
+            const double due = deadline(tile);
+            if (!(state == GrassState::EATEN ? due < m_now : due < start)) {
+                m_wheel.schedule(tick_of(due), event); //Same wheel tick but not due yet, try again next tick
+                continue;
+            }
+            if (state == GrassState::EATEN) {
+                tile.m_state = GrassState::SEED;
+                tile.m_since = m_now;
+                m_revived.push_back(Chunk::tile_of(m_tiles.chunk_coord(chunk), local));
+            }
+            else {
+                tile.m_state = GrassState(uint8_t(state) + 1); //Age carries on, one state per tick at most
+            }
+            schedule(chunk, tile, local);
+        }
+        std::sort(m_revived.begin(), m_revived.end(), [](const Point& a, const Point& b) {
+            return a.y != b.y ? a.y < b.y : a.x < b.x;
+            });
+    }
+}
@@ -0,0 +1,93 @@
+// handle.cpp
+
+#include "handle.hpp"
+
+namespace sim
+{
+    void HandleTable::clear()
+    {
+        //Bump every generation so handles from before the clear stay stale
+        m_free.clear();
+        for (uint32_t slot = 0; slot < (uint32_t)m_index.size(); slot++) {
+            if (m_index[slot] != NONE) {
+                m_generation[slot]++;
+                m_index[slot] = NONE;
+            }
+            m_free.push_back(slot);
+        }
+        m_slot_of.clear();
+    }
+
+    Handle HandleTable::create(int index)
+    {
+        uint32_t slot;
+        if (m_free.empty()) {
+            slot = (uint32_t)m_index.size();
+            m_index.push_back(NONE);
+            m_generation.push_back(0);
+        }
+        else {
+            slot = m_free.back();
+            m_free.pop_back();
+        }
+        m_index[slot] = index;
+        if ((int)m_slot_of.size() <= index) {
+            m_slot_of.resize(size_t(index) + 1, Handle::NONE);
+        }
+        m_slot_of[index] = slot;
+        return Handle{ slot, m_generation[slot] };
+    }
+
+    void HandleTable::destroy(const Handle& handle)
+    {
+        const int index = resolve(handle);
+        if (index == NONE) {
+            return;
+        }
+        m_slot_of[index] = Handle::NONE;
+        m_index[handle.m_slot] = NONE;
+        m_generation[handle.m_slot]++;
+        m_free.push_back(handle.m_slot);
+    }
+
+    int HandleTable::resolve(const Handle& handle) const
+    {
+        if (handle.m_slot >= (uint32_t)m_index.size() || m_generation[handle.m_slot] != handle.m_generation) {
+            return NONE;
+        }
+        return m_index[handle.m_slot];
+    }
+
+    Handle HandleTable::handle_of(int index) const
+    {
+        if (index < 0 || index >= size() || m_slot_of[index] == Handle::NONE) {
+            return Handle{};
+        }
+        const uint32_t slot = m_slot_of[index];
+        return Handle{ slot, m_generation[slot] };
+    }
+
+    void HandleTable::compact(const std::vector<int>& remap)
+    {
+        std::vector<uint32_t> slot_of;
+        for (int index = 0; index < size(); index++) {
+            const uint32_t slot = m_slot_of[index];
+            if (slot == Handle::NONE) {
+                continue;
+            }
+            const int moved = index < (int)remap.size() ? remap[index] : index;
+            if (moved == NONE) {
+                m_index[slot] = NONE;
+                m_generation[slot]++;
+                m_free.push_back(slot);
+                continue;
+            }
+            m_index[slot] = moved;
+            if ((int)slot_of.size() <= moved) {
+                slot_of.resize(size_t(moved) + 1, Handle::NONE);
+            }
+            slot_of[moved] = slot;
+        }
+        m_slot_of.swap(slot_of);
+    }
+}
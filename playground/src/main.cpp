@@ -1,6 +1,8 @@
 // main.cpp
 
 #include "appstate.hpp"
+#include <cstdlib>
+#include <cstring>
    
 int main(int argc, char **argv)
 {
@@ -14,6 +16,11 @@ int main(int argc, char **argv)
 
    sim::AppState app;
    app.init(window_width, window_height);
+   for (int i = 1; i + 1 < argc; i++) {
+      if (std::strcmp(argv[i], "--tick-rate") == 0) {
+         app.m_clock.set_rate(std::atoi(argv[i + 1]));
+      }
+   }
 
    bool running = true;
    while (running) {
@@ -0,0 +1,100 @@
+// manure_pool.cpp
+
+#include "manure_pool.hpp"
+#include "entity.hpp"
+
+namespace sim
+{
+    void ManurePool::reset(const Point& size)
+    {
+        m_size = size;
+        m_blocks.clear();
+        m_free.clear();
+        m_live.clear();
+        m_live_index.clear();
+        m_slot_tile.clear();
+        m_tile_slot.assign(size_t(size.x) * size_t(size.y), NONE);
+        m_handles.clear();
+    }
+
+    bool ManurePool::grow()
+    {
+        const int first = (int)capacity();
+        if (first >= (int)m_tile_slot.size()) {
+            return false;
+        }
+        m_blocks.push_back(std::make_unique<Manure[]>(BLOCK_SIZE));
+        m_live_index.resize(first + BLOCK_SIZE, NONE);
+        m_slot_tile.resize(first + BLOCK_SIZE, NONE);
+        for (int i = BLOCK_SIZE - 1; i >= 0; i--) { //Hand out the low slots first
+            m_free.push_back(first + i);
+        }
+        return true;
+    }
+
+    int ManurePool::slot_at(const Point& tile) const
+    {
+        if (tile.has_negative() || tile.x >= m_size.x || tile.y >= m_size.y) {
+            return NONE;
+        }
+        return m_tile_slot[tile.y * m_size.x + tile.x];
+    }
+
+    Manure* ManurePool::spawn(World* world, const Point& tile)
+    {
+        if (tile.has_negative() || tile.x >= m_size.x || tile.y >= m_size.y || has(tile)) {
+            return nullptr;
+        }
+        if (m_free.empty() && !grow()) {
+            return nullptr;
+        }
+        const int slot = m_free.back();
+        m_free.pop_back();
+        const int tile_index = tile.y * m_size.x + tile.x;
+        m_tile_slot[tile_index] = slot;
+        m_slot_tile[slot] = tile_index;
+        m_live_index[slot] = (int)m_live.size();
+        m_live.push_back(slot);
+
+        Manure& manure = (*this)[slot];
+        manure = Manure(world);
+        m_handles.create(slot);
+        return &manure;
+    }
+
+    void ManurePool::release(int slot)
+    {
+        m_handles.destroy(m_handles.handle_of(slot));
+        const int index = m_live_index[slot];
+        const int last = m_live.back();
+        m_live[index] = last;
+        m_live_index[last] = index;
+        m_live.pop_back();
+
+        m_live_index[slot] = NONE;
+        m_tile_slot[m_slot_tile[slot]] = NONE;
+        m_slot_tile[slot] = NONE;
+        m_free.push_back(slot);
+    }
+
+    Manure* ManurePool::resolve(const Handle& handle)
+    {
+        const int slot = m_handles.resolve(handle);
+        return slot == NONE ? nullptr : &(*this)[slot];
+    }
+
+    void ManurePool::update(float dt)
+    {
+        for (size_t i = 0; i < m_live.size();) {
+            const int slot = m_live[i];
+            Manure& manure = (*this)[slot];
+            manure.update(dt);
+            if (manure.m_isActive) {
+                i++;
+            }
+            else { //The last live slot moves into this position and still needs its update
+                release(slot);
+            }
+        }
+    }
+}
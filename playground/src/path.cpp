@@ -0,0 +1,156 @@
+// path.cpp
+
+#include "path.hpp"
+#include "pathfinding.h"
+#include "world.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+namespace sim
+{
+    namespace {
+        // note: the run directions, in code order
+        constexpr Point STEPS[] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+    }
+
+    Path::Path(Path&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    Path& Path::operator=(Path&& other) noexcept
+    {
+        if (this != &other) {
+            clear();
+            m_arena = other.m_arena;
+            m_read_block = other.m_read_block;
+            m_write_block = other.m_write_block;
+            m_read_at = other.m_read_at;
+            m_write_at = other.m_write_at;
+            m_size = other.m_size;
+            m_front = other.m_front;
+            m_back = other.m_back;
+            other.m_read_block = PathArena::NONE;
+            other.m_write_block = PathArena::NONE;
+            other.m_size = 0;
+        }
+        return *this;
+    }
+
+    Path::~Path()
+    {
+        clear();
+    }
+
+    void Path::assign(PathArena& arena, const std::vector<Point>& waypoints)
+    {
+        clear();
+        for (const Point& waypoint : waypoints) {
+            push_back(arena, waypoint);
+        }
+    }
+
+    void Path::assign_smoothed(World& world, std::vector<Point> tiles)
+    {
+        smoothPath(world, tiles);
+        assign(world.m_path_arena, tiles);
+    }
+
+    void Path::clear()
+    {
+        if (m_arena) {
+            m_arena->release_chain(m_read_block);
+        }
+        m_read_block = PathArena::NONE;
+        m_write_block = PathArena::NONE;
+        m_read_at = 0;
+        m_write_at = 0;
+        m_size = 0;
+    }
+
+    void Path::push_back(PathArena& arena, const Point& waypoint)
+    {
+        if (empty()) { //Drop the consumed waypoints instead of growing behind the cursor
+            clear();
+            m_arena = &arena;
+            m_front = waypoint;
+            m_back = waypoint;
+            m_size = 1;
+            return;
+        }
+
+        //Runs along x first and then y, the last one closes the waypoint
+        const int dx = waypoint.x - m_back.x;
+        const int dy = waypoint.y - m_back.y;
+        int x_left = std::abs(dx);
+        int y_left = std::abs(dy);
+        const int x_direction = dx > 0 ? 0 : 1;
+        const int y_direction = dy > 0 ? 2 : 3;
+        if (x_left == 0 && y_left == 0) {
+            write(PathArena::code(0, 0, true));
+        }
+        while (x_left > 0) {
+            const int run = std::min(x_left, PathArena::MAX_RUN);
+            x_left -= run;
+            write(PathArena::code(x_direction, run, x_left == 0 && y_left == 0));
+        }
+        while (y_left > 0) {
+            const int run = std::min(y_left, PathArena::MAX_RUN);
+            y_left -= run;
+            write(PathArena::code(y_direction, run, y_left == 0));
+        }
+        m_back = waypoint;
+        m_size++;
+    }
+
+    void Path::advance()
+    {
+        if (m_size <= 1) {
+            clear();
+            return;
+        }
+        int block = m_read_block;
+        int offset = m_read_at;
+        read(block, offset, m_front, true);
+        m_read_block = block;
+        m_read_at = uint8_t(offset);
+        m_size--;
+    }
+
+    void Path::write(uint8_t code)
+    {
+        if (m_write_block == PathArena::NONE) {
+            m_write_block = m_arena->allocate();
+            m_read_block = m_write_block;
+            m_read_at = 0;
+            m_write_at = 0;
+        }
+        else if (m_write_at == PathArena::BLOCK_CODES) {
+            const int next = m_arena->allocate();
+            m_arena->m_blocks[m_write_block].m_next = next;
+            m_write_block = next;
+            m_write_at = 0;
+        }
+        m_arena->m_blocks[m_write_block].m_codes[m_write_at++] = code;
+    }
+
+    void Path::read(int& block, int& offset, Point& at, bool release) const
+    {
+        uint8_t code;
+        do {
+            if (offset == PathArena::BLOCK_CODES) { //Move on to the next block, handing back the one read through
+                const int next = m_arena->m_blocks[block].m_next;
+                if (release) {
+                    m_arena->release(block);
+                }
+                block = next;
+                offset = 0;
+            }
+            code = m_arena->m_blocks[block].m_codes[offset++];
+            const Point& step = STEPS[PathArena::direction(code)];
+            const int length = PathArena::length(code);
+            at.x += step.x * length;
+            at.y += step.y * length;
+        } while (!(code & PathArena::LAST));
+    }
+}
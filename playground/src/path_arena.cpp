@@ -0,0 +1,35 @@
+// path_arena.cpp
+
+#include "path_arena.hpp"
+
+namespace sim
+{
+    int PathArena::allocate()
+    {
+        int block;
+        if (m_free.empty()) {
+            block = (int)m_blocks.size();
+            m_blocks.emplace_back();
+        }
+        else {
+            block = m_free.back();
+            m_free.pop_back();
+        }
+        m_blocks[block].m_next = NONE;
+        return block;
+    }
+
+    void PathArena::release(int block)
+    {
+        m_free.push_back(block);
+    }
+
+    void PathArena::release_chain(int first)
+    {
+        while (first != NONE) {
+            const int next = m_blocks[first].m_next;
+            release(first);
+            first = next;
+        }
+    }
+}
@@ -0,0 +1,149 @@
+// path_cache.cpp
+
+#include "path_cache.hpp"
+#include <algorithm>
+
+namespace sim
+{
+    size_t PathCache::KeyHash::operator()(const Key& key) const
+    {
+        uint64_t hash = 1469598103934665603ull;
+        auto mix = [&hash](uint64_t value) {
+            hash ^= value;
+            hash *= 1099511628211ull;
+            };
+        mix(uint64_t(uint32_t(key.m_start.x)) << 32 | uint32_t(key.m_start.y));
+        mix(uint64_t(uint32_t(key.m_goal.x)) << 32 | uint32_t(key.m_goal.y));
+        mix(uint64_t(key.m_epoch) << 8 | uint64_t(key.m_algorithm));
+        return size_t(hash);
+    }
+
+    PathCache::Key PathCache::goal_key(const Key& key) const
+    {
+        Key result = key;
+        result.m_start = Point(0, 0);
+        return result;
+    }
+
+    bool PathCache::lookup(const Key& key, std::vector<Point>& path)
+    {
+        m_lookups++;
+
+        auto exact = m_exact.find(key);
+        if (exact != m_exact.end()) {
+            m_hits++;
+            touch(exact->second);
+            path = m_entries[exact->second].m_path;
+            return true;
+        }
+
+        //Any cached route towards the same goal that passes through our start can be reused from there
+        auto bucket = m_by_goal.find(goal_key(key));
+        if (bucket == m_by_goal.end()) {
+            return false;
+        }
+        for (int slot : bucket->second) {
+            const std::vector<Point>& cached = m_entries[slot].m_path;
+            auto it = std::find(cached.begin(), cached.end(), key.m_start);
+            if (it != cached.end()) {
+                m_hits++;
+                m_suffix_hits++;
+                touch(slot);
+                path.assign(it, cached.end());
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void PathCache::store(const Key& key, const std::vector<Point>& path)
+    {
+        if (m_exact.count(key)) {
+            return;
+        }
+
+        int slot = -1;
+        if ((int)m_entries.size() < CAPACITY) {
+            slot = (int)m_entries.size();
+            m_entries.emplace_back();
+        }
+        else { //Evict the least recently used entry and recycle its slot
+            slot = m_tail;
+            Entry& old = m_entries[slot];
+            m_exact.erase(old.m_key);
+            if (!old.m_path.empty()) {
+                auto bucket = m_by_goal.find(goal_key(old.m_key));
+                std::vector<int>& slots = bucket->second;
+                slots.erase(std::find(slots.begin(), slots.end(), slot));
+                if (slots.empty()) {
+                    m_by_goal.erase(bucket);
+                }
+            }
+            unlink(slot);
+        }
+
+        Entry& entry = m_entries[slot];
+        entry.m_key = key;
+        entry.m_path.assign(path.begin(), path.end());
+        m_exact[key] = slot;
+        if (!path.empty()) {
+            m_by_goal[goal_key(key)].push_back(slot);
+        }
+        push_front(slot);
+    }
+
+    void PathCache::clear()
+    {
+        m_entries.clear();
+        m_exact.clear();
+        m_by_goal.clear();
+        m_head = -1;
+        m_tail = -1;
+    }
+
+    float PathCache::hit_rate() const
+    {
+        return m_lookups == 0 ? 0.0f : float(m_hits) / float(m_lookups);
+    }
+
+    void PathCache::touch(int slot)
+    {
+        if (slot != m_head) {
+            unlink(slot);
+            push_front(slot);
+        }
+    }
+
+    void PathCache::unlink(int slot)
+    {
+        Entry& entry = m_entries[slot];
+        if (entry.m_prev != -1) {
+            m_entries[entry.m_prev].m_next = entry.m_next;
+        }
+        else {
+            m_head = entry.m_next;
+        }
+        if (entry.m_next != -1) {
+            m_entries[entry.m_next].m_prev = entry.m_prev;
+        }
+        else {
+            m_tail = entry.m_prev;
+        }
+        entry.m_prev = -1;
+        entry.m_next = -1;
+    }
+
+    void PathCache::push_front(int slot)
+    {
+        Entry& entry = m_entries[slot];
+        entry.m_prev = -1;
+        entry.m_next = m_head;
+        if (m_head != -1) {
+            m_entries[m_head].m_prev = slot;
+        }
+        m_head = slot;
+        if (m_tail == -1) {
+            m_tail = slot;
+        }
+    }
+}
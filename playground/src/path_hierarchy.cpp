@@ -0,0 +1,390 @@
+// path_hierarchy.cpp
+
+#include "path_hierarchy.hpp"
+#include "world.hpp"
+
+namespace sim
+{
+    namespace
+    {
+        constexpr int UNREACHED = PathSearchContext::UNREACHED;
+        constexpr Point DIRECTIONS[] = { {0, -1}, {0, 1}, {-1, 0}, {1, 0} };
+
+        uint64_t open_key(int fCost, uint32_t sequence)
+        {
+            return (uint64_t(uint32_t(fCost)) << 32) | sequence;
+        }
+
+        // note: scratch buffers for the in-cluster searches, reused across queries
+        struct ClusterScratch {
+            std::vector<int> m_distance;
+            std::vector<int> m_queue;
+            std::vector<int> m_start_distances;
+            std::vector<int> m_goal_distances;
+            std::vector<int> m_abstract_path;
+        };
+
+        ClusterScratch& cluster_scratch()
+        {
+            thread_local ClusterScratch scratch;
+            return scratch;
+        }
+    }
+
+    void PathHierarchy::rebuild(const World& world)
+    {
+        m_world_size = world.m_world_size;
+        m_cluster_count = {
+            (m_world_size.x + CLUSTER_SIZE - 1) / CLUSTER_SIZE,
+            (m_world_size.y + CLUSTER_SIZE - 1) / CLUSTER_SIZE
+        };
+
+        m_clusters.assign(m_cluster_count.x * m_cluster_count.y, Cluster{});
+        for (int cy = 0; cy < m_cluster_count.y; cy++) {
+            for (int cx = 0; cx < m_cluster_count.x; cx++) {
+                Cluster& cluster = m_clusters[cy * m_cluster_count.x + cx];
+                cluster.m_min = { cx * CLUSTER_SIZE, cy * CLUSTER_SIZE };
+                cluster.m_max = {
+                    Math::min(cluster.m_min.x + CLUSTER_SIZE, m_world_size.x) - 1,
+                    Math::min(cluster.m_min.y + CLUSTER_SIZE, m_world_size.y) - 1
+                };
+            }
+        }
+
+        m_vertical_borders.assign(Math::max(m_cluster_count.x - 1, 0) * m_cluster_count.y, Border{});
+        m_horizontal_borders.assign(m_cluster_count.x * Math::max(m_cluster_count.y - 1, 0), Border{});
+        for (int cy = 0; cy < m_cluster_count.y; cy++) {
+            for (int cx = 0; cx < m_cluster_count.x; cx++) {
+                if (cx + 1 < m_cluster_count.x) {
+                    rebuild_vertical_border(world, cx, cy);
+                }
+                if (cy + 1 < m_cluster_count.y) {
+                    rebuild_horizontal_border(world, cx, cy);
+                }
+            }
+        }
+
+        for (int cy = 0; cy < m_cluster_count.y; cy++) {
+            for (int cx = 0; cx < m_cluster_count.x; cx++) {
+                rebuild_cluster(world, cx, cy);
+            }
+        }
+    }
+
+    void PathHierarchy::on_walkability_changed(const World& world, const Point& coord)
+    {
+        if (m_clusters.empty()) {
+            return;
+        }
+        const int cx = coord.x / CLUSTER_SIZE;
+        const int cy = coord.y / CLUSTER_SIZE;
+        const Cluster& cluster = m_clusters[cy * m_cluster_count.x + cx];
+
+        //A tile on the cluster edge also changes the entrances shared with the neighbour
+        if (coord.x == cluster.m_min.x && cx > 0) {
+            rebuild_vertical_border(world, cx - 1, cy);
+            rebuild_cluster(world, cx - 1, cy);
+        }
+        if (coord.x == cluster.m_max.x && cx + 1 < m_cluster_count.x) {
+            rebuild_vertical_border(world, cx, cy);
+            rebuild_cluster(world, cx + 1, cy);
+        }
+        if (coord.y == cluster.m_min.y && cy > 0) {
+            rebuild_horizontal_border(world, cx, cy - 1);
+            rebuild_cluster(world, cx, cy - 1);
+        }
+        if (coord.y == cluster.m_max.y && cy + 1 < m_cluster_count.y) {
+            rebuild_horizontal_border(world, cx, cy);
+            rebuild_cluster(world, cx, cy + 1);
+        }
+        rebuild_cluster(world, cx, cy);
+    }
+
+    int PathHierarchy::cluster_index(const Point& coord) const
+    {
+        return (coord.y / CLUSTER_SIZE) * m_cluster_count.x + (coord.x / CLUSTER_SIZE);
+    }
+
+    int PathHierarchy::node_slot(const Cluster& cluster, int tile) const
+    {
+        for (int i = 0; i < (int)cluster.m_nodes.size(); i++) {
+            if (cluster.m_nodes[i] == tile) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    void PathHierarchy::rebuild_vertical_border(const World& world, int cx, int cy)
+    {
+        Border& border = m_vertical_borders[cy * (m_cluster_count.x - 1) + cx];
+        border.m_links.clear();
+
+        const Cluster& first = m_clusters[cy * m_cluster_count.x + cx];
+        const int xa = first.m_max.x;
+        const int xb = xa + 1;
+        auto open = [&](int y) { return world.m_walkable.test({ xa, y }) && world.m_walkable.test({ xb, y }); };
+        auto link = [&](int y) { border.m_links.push_back({ y * m_world_size.x + xa, y * m_world_size.x + xb }); };
+
+        for (int y = first.m_min.y; y <= first.m_max.y; y++) {
+            if (!open(y)) {
+                continue;
+            }
+            const int runStart = y;
+            while (y + 1 <= first.m_max.y && open(y + 1)) {
+                y++;
+            }
+            const int runLength = y - runStart + 1;
+            if (runLength < ENTRANCE_SPLIT_LENGTH) {
+                link(runStart + runLength / 2);
+            }
+            else {
+                link(runStart);
+                link(y);
+            }
+        }
+    }
+
+    void PathHierarchy::rebuild_horizontal_border(const World& world, int cx, int cy)
+    {
+        Border& border = m_horizontal_borders[cy * m_cluster_count.x + cx];
+        border.m_links.clear();
+
+        const Cluster& first = m_clusters[cy * m_cluster_count.x + cx];
+        const int ya = first.m_max.y;
+        const int yb = ya + 1;
+        auto open = [&](int x) { return world.m_walkable.test({ x, ya }) && world.m_walkable.test({ x, yb }); };
+        auto link = [&](int x) { border.m_links.push_back({ ya * m_world_size.x + x, yb * m_world_size.x + x }); };
+
+        for (int x = first.m_min.x; x <= first.m_max.x; x++) {
+            if (!open(x)) {
+                continue;
+            }
+            const int runStart = x;
+            while (x + 1 <= first.m_max.x && open(x + 1)) {
+                x++;
+            }
+            const int runLength = x - runStart + 1;
+            if (runLength < ENTRANCE_SPLIT_LENGTH) {
+                link(runStart + runLength / 2);
+            }
+            else {
+                link(runStart);
+                link(x);
+            }
+        }
+    }
+
+    void PathHierarchy::rebuild_cluster(const World& world, int cx, int cy)
+    {
+        Cluster& cluster = m_clusters[cy * m_cluster_count.x + cx];
+        cluster.m_nodes.clear();
+        cluster.m_links.clear();
+
+        auto add_link = [&cluster, this](int tile, int partner) {
+            int slot = node_slot(cluster, tile);
+            if (slot < 0) {
+                slot = (int)cluster.m_nodes.size();
+                cluster.m_nodes.push_back(tile);
+            }
+            cluster.m_links.push_back({ slot, partner });
+            };
+
+        if (cx > 0) {
+            for (const auto& [tile, partner] : m_vertical_borders[cy * (m_cluster_count.x - 1) + cx - 1].m_links) {
+                add_link(partner, tile);
+            }
+        }
+        if (cx + 1 < m_cluster_count.x) {
+            for (const auto& [tile, partner] : m_vertical_borders[cy * (m_cluster_count.x - 1) + cx].m_links) {
+                add_link(tile, partner);
+            }
+        }
+        if (cy > 0) {
+            for (const auto& [tile, partner] : m_horizontal_borders[(cy - 1) * m_cluster_count.x + cx].m_links) {
+                add_link(partner, tile);
+            }
+        }
+        if (cy + 1 < m_cluster_count.y) {
+            for (const auto& [tile, partner] : m_horizontal_borders[cy * m_cluster_count.x + cx].m_links) {
+                add_link(tile, partner);
+            }
+        }
+
+        const int count = (int)cluster.m_nodes.size();
+        cluster.m_distances.assign(count * count, UNREACHED);
+        std::vector<int> row;
+        for (int i = 0; i < count; i++) {
+            distances_within(world, cluster, cluster.m_nodes[i], row);
+            std::copy(row.begin(), row.end(), cluster.m_distances.begin() + i * count);
+        }
+    }
+
+    void PathHierarchy::distances_within(const World& world, const Cluster& cluster, int from, std::vector<int>& distances) const
+    {
+        //Breadth first flood that never leaves the cluster rectangle
+        ClusterScratch& scratch = cluster_scratch();
+        const Point size = cluster.m_max - cluster.m_min + Point(1, 1);
+        scratch.m_distance.assign(size.x * size.y, UNREACHED);
+        scratch.m_queue.clear();
+
+        auto local = [&](const Point& p) { return (p.y - cluster.m_min.y) * size.x + (p.x - cluster.m_min.x); };
+        const Point origin(from % m_world_size.x, from / m_world_size.x);
+        scratch.m_distance[local(origin)] = 0;
+        scratch.m_queue.push_back(local(origin));
+
+        for (size_t head = 0; head < scratch.m_queue.size(); head++) {
+            const int current = scratch.m_queue[head];
+            const Point coord = cluster.m_min + Point(current % size.x, current / size.x);
+            for (const Point& d : DIRECTIONS) {
+                const Point next = coord + d;
+                if (next.x < cluster.m_min.x || next.y < cluster.m_min.y || next.x > cluster.m_max.x || next.y > cluster.m_max.y) {
+                    continue;
+                }
+                const int nextLocal = local(next);
+                if (scratch.m_distance[nextLocal] != UNREACHED || !world.m_walkable.test(next)) {
+                    continue;
+                }
+                scratch.m_distance[nextLocal] = scratch.m_distance[current] + 1;
+                scratch.m_queue.push_back(nextLocal);
+            }
+        }
+
+        distances.resize(cluster.m_nodes.size());
+        for (size_t i = 0; i < cluster.m_nodes.size(); i++) {
+            const int tile = cluster.m_nodes[i];
+            distances[i] = scratch.m_distance[local(Point(tile % m_world_size.x, tile / m_world_size.x))];
+        }
+    }
+
+    std::vector<Point> PathHierarchy::find_path(const World& world, const Point& start, const Point& goal) const
+    {
+        std::vector<Point> path;
+        if (!world.is_valid_coord(start) || !world.is_valid_coord(goal) || m_clusters.empty()) {
+            return path;
+        }
+        if (start == goal) {
+            path.push_back(start);
+            return path;
+        }
+        if (!world.is_walkable(goal)) {
+            return path;
+        }
+        if (!world.is_walkable(start)) {
+            //Entrances only model walkable crossings, so step off a blocked start tile first
+            for (const Point& d : DIRECTIONS) {
+                const Point next = start + d;
+                if (!world.is_valid_coord(next) || !world.is_walkable(next)) {
+                    continue;
+                }
+                std::vector<Point> candidate = find_path(world, next, goal);
+                if (!candidate.empty() && (path.empty() || candidate.size() + 1 < path.size())) {
+                    path.clear();
+                    path.push_back(start);
+                    path.insert(path.end(), candidate.begin(), candidate.end());
+                }
+            }
+            return path;
+        }
+
+        const Cluster& startCluster = m_clusters[cluster_index(start)];
+        const Cluster& goalCluster = m_clusters[cluster_index(goal)];
+        if (&startCluster == &goalCluster &&
+            appendPathWithin(world, start, goal, startCluster.m_min, startCluster.m_max, path)) {
+            return path;
+        }
+
+        // note: start and goal are connected to their cluster entrances for this query only
+        ClusterScratch& scratch = cluster_scratch();
+        const int startIndex = start.y * m_world_size.x + start.x;
+        const int goalIndex = goal.y * m_world_size.x + goal.x;
+        distances_within(world, startCluster, startIndex, scratch.m_start_distances);
+        distances_within(world, goalCluster, goalIndex, scratch.m_goal_distances);
+
+        PathSearchContext& context = search_context();
+        context.begin(m_world_size.x * m_world_size.y);
+        IndexedHeap& openList = context.m_open;
+
+        auto coord = [this](int tile) { return Point(tile % m_world_size.x, tile / m_world_size.x); };
+        auto relax = [&](int from, int to, int cost) {
+            if (cost == UNREACHED || context.is_closed(to)) {
+                return;
+            }
+            const int gCost = context.g(from) + cost;
+            const int fCost = gCost + heuristic(coord(to), goal);
+            if (!context.is_reached(to)) {
+                context.reach(to, gCost, from);
+                openList.push(to, open_key(fCost, context.m_sequence++));
+            }
+            else if (gCost < context.g(to)) {
+                const uint32_t sequence = uint32_t(openList.key_of(to));
+                context.reach(to, gCost, from);
+                openList.update(to, open_key(fCost, sequence));
+            }
+            };
+
+        context.reach(startIndex, 0, -1);
+        openList.push(startIndex, open_key(heuristic(start, goal), context.m_sequence++));
+
+        bool found = false;
+        while (!openList.empty()) {
+            const int current = openList.pop();
+            if (current == goalIndex) {
+                found = true;
+                break;
+            }
+            context.close(current);
+
+            const Cluster& cluster = m_clusters[cluster_index(coord(current))];
+            const int slot = node_slot(cluster, current);
+            const int count = (int)cluster.m_nodes.size();
+            if (current == startIndex) {
+                for (int j = 0; j < count; j++) {
+                    relax(current, cluster.m_nodes[j], scratch.m_start_distances[j]);
+                }
+            }
+            else if (slot >= 0) {
+                for (int j = 0; j < count; j++) {
+                    if (j != slot) {
+                        relax(current, cluster.m_nodes[j], cluster.m_distances[slot * count + j]);
+                    }
+                }
+            }
+            if (slot < 0) {
+                continue;
+            }
+            for (const auto& [local, partner] : cluster.m_links) {
+                if (local == slot) {
+                    relax(current, partner, 1);
+                }
+            }
+            if (&cluster == &goalCluster) {
+                relax(current, goalIndex, scratch.m_goal_distances[slot]);
+            }
+        }
+        if (!found) {
+            return path;
+        }
+
+        //Refine every abstract hop with a search bounded to the cluster it crosses
+        scratch.m_abstract_path.clear();
+        for (int node = goalIndex; node != -1; node = context.parent(node)) {
+            scratch.m_abstract_path.push_back(node);
+        }
+        path.reserve(context.g(goalIndex) + 1);
+        path.push_back(start);
+        for (int i = (int)scratch.m_abstract_path.size() - 1; i > 0; i--) {
+            const Point from = coord(scratch.m_abstract_path[i]);
+            const Point to = coord(scratch.m_abstract_path[i - 1]);
+            if (heuristic(from, to) == 1) {
+                path.push_back(to);
+                continue;
+            }
+            const Cluster& cluster = m_clusters[cluster_index(from)];
+            if (!appendPathWithin(world, from, to, cluster.m_min, cluster.m_max, path)) {
+                return std::vector<Point>();
+            }
+        }
+        return path;
+    }
+}
@@ -0,0 +1,137 @@
+// path_requests.cpp
+
+#include "path_requests.hpp"
+#include "world.hpp"
+#include <chrono>
+
+namespace sim
+{
+    uint32_t PathRequestQueue::submit(const Point& start, const Point& goal, PathAlgorithm algorithm, PathPriority priority)
+    {
+        const uint32_t ticket = m_next_ticket++;
+        if (m_next_ticket == 0) {
+            m_next_ticket = 1;
+        }
+
+        Request& request = m_requests[ticket];
+        request.m_start = start;
+        request.m_goal = goal;
+        request.m_algorithm = algorithm;
+        m_queues[int(priority)].push_back(ticket);
+        return ticket;
+    }
+
+    bool PathRequestQueue::claim(uint32_t& ticket, std::vector<Point>& path)
+    {
+        if (ticket == 0) {
+            return false;
+        }
+        auto it = m_requests.find(ticket);
+        if (it == m_requests.end()) { //Expired or cancelled, let the caller ask again
+            ticket = 0;
+            return false;
+        }
+        if (!it->second.m_done) {
+            return false;
+        }
+        path = std::move(it->second.m_path);
+        m_requests.erase(it);
+        ticket = 0;
+        return true;
+    }
+
+    void PathRequestQueue::cancel(uint32_t& ticket)
+    {
+        // note: a queued ticket stays in its queue and is skipped once it comes up
+        if (ticket != 0) {
+            m_requests.erase(ticket);
+            ticket = 0;
+        }
+    }
+
+    void PathRequestQueue::process(World& world)
+    {
+        m_tick++;
+        while (!m_finished.empty()) {
+            auto it = m_requests.find(m_finished.front());
+            if (it != m_requests.end() && m_tick - it->second.m_finished_tick <= RESULT_LIFETIME_TICKS) {
+                break;
+            }
+            if (it != m_requests.end()) {
+                m_requests.erase(it);
+            }
+            m_finished.pop_front();
+        }
+
+        //Always solve at least one batch so a single slow search cannot starve the queue
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point start = Clock::now();
+        bool solved_any = false;
+        while (pending() > 0) {
+            if (solved_any && std::chrono::duration<double>(Clock::now() - start).count() >= TICK_BUDGET_SECONDS) {
+                m_deferred_ticks++;
+                return;
+            }
+            solve_batch(world);
+            solved_any = true;
+        }
+    }
+
+    void PathRequestQueue::solve_batch(World& world)
+    {
+        m_batch.clear();
+        for (int level = int(PathPriority::High); level >= int(PathPriority::Normal); level--) {
+            std::deque<uint32_t>& queue = m_queues[level];
+            while (!queue.empty() && (int)m_batch.size() < BATCH_SIZE) {
+                if (m_requests.count(queue.front())) {
+                    m_batch.push_back(queue.front());
+                }
+                queue.pop_front();
+            }
+        }
+
+        //Unreachable goals and cache hits are answered right away, identical searches only run once
+        m_searches.clear();
+        m_search_slots.clear();
+        for (uint32_t ticket : m_batch) {
+            Request& request = m_requests[ticket];
+            if (world.find_path_cached(request.m_start, request.m_goal, request.m_algorithm, request.m_path)) {
+                finish(ticket, request);
+                continue;
+            }
+            const PathCache::Key key{ request.m_start, request.m_goal, world.m_walkability_epoch, request.m_algorithm };
+            auto [slot, inserted] = m_search_slots.emplace(key, (int)m_searches.size());
+            if (inserted) {
+                m_searches.push_back({ key, {} });
+            }
+            request.m_search = slot->second;
+        }
+
+        // note: nothing writes to the world while the searches run, it serves as their snapshot
+        const World& snapshot = world;
+        world.m_thread_pool.parallel_for((int)m_searches.size(), [this, &snapshot](int i) {
+            Search& search = m_searches[i];
+            search.m_path = findPath(snapshot, search.m_key.m_start, search.m_key.m_goal, search.m_key.m_algorithm);
+            });
+
+        for (const Search& search : m_searches) {
+            world.store_path(search.m_key.m_start, search.m_key.m_goal, search.m_key.m_algorithm, search.m_path);
+        }
+        for (uint32_t ticket : m_batch) {
+            Request& request = m_requests[ticket];
+            if (!request.m_done) {
+                request.m_path = m_searches[request.m_search].m_path;
+                request.m_search = -1;
+                finish(ticket, request);
+            }
+        }
+    }
+
+    void PathRequestQueue::finish(uint32_t ticket, Request& request)
+    {
+        request.m_done = true;
+        request.m_finished_tick = m_tick;
+        m_finished.push_back(ticket);
+        m_solved++;
+    }
+}
@@ -3,81 +3,494 @@
 
 
 namespace sim {
+    void IndexedHeap::resize(int count) {
+        const int pages = (count + PAGE_SIZE - 1) >> PAGE_BITS;
+        if ((int)m_pages.size() < pages) {
+            m_pages.resize(pages);
+        }
+    }
+
+    void IndexedHeap::clear() {
+        m_entries.clear();
+    }
+
+    bool IndexedHeap::contains(int index) const {
+        //Positions are never reset, so an entry only counts if the slot it points at agrees
+        if (!m_pages[index >> PAGE_BITS]) {
+            return false;
+        }
+        const int position = position_of(index);
+        return position >= 0 && position < (int)m_entries.size() && m_entries[position].index == index;
+    }
+
+    uint64_t IndexedHeap::key_of(int index) const {
+        return m_entries[position_of(index)].key;
+    }
+
+    void IndexedHeap::push(int index, uint64_t key) {
+        std::unique_ptr<int[]>& page = m_pages[index >> PAGE_BITS];
+        if (!page) {
+            page = std::make_unique<int[]>(PAGE_SIZE); // note: zeroed, contains() checks the entry anyway
+        }
+        m_entries.push_back({ key, index });
+        position_of(index) = (int)m_entries.size() - 1;
+        sift_up((int)m_entries.size() - 1);
+    }
+
+    void IndexedHeap::update(int index, uint64_t key) {
+        const int position = position_of(index);
+        const uint64_t previous = m_entries[position].key;
+        m_entries[position].key = key;
+        if (key < previous) {
+            sift_up(position);
+        }
+        else {
+            sift_down(position);
+        }
+    }
+
+    void IndexedHeap::remove(int index) {
+        const int position = position_of(index);
+        const Entry last = m_entries.back();
+        m_entries.pop_back();
+        if (position == (int)m_entries.size()) {
+            return;
+        }
+        place(position, last);
+        sift_up(position);
+        sift_down(position_of(last.index));
+    }
+
+    int IndexedHeap::pop() {
+        const int index = m_entries.front().index;
+        remove(index);
+        return index;
+    }
+
+    void IndexedHeap::sift_up(int position) {
+        const Entry entry = m_entries[position];
+        while (position > 0) {
+            const int parent = (position - 1) / 2;
+            if (m_entries[parent].key <= entry.key) {
+                break;
+            }
+            place(position, m_entries[parent]);
+            position = parent;
+        }
+        place(position, entry);
+    }
+
+    void IndexedHeap::sift_down(int position) {
+        const int count = (int)m_entries.size();
+        const Entry entry = m_entries[position];
+        while (true) {
+            int child = position * 2 + 1;
+            if (child >= count) {
+                break;
+            }
+            if (child + 1 < count && m_entries[child + 1].key < m_entries[child].key) {
+                child++;
+            }
+            if (entry.key <= m_entries[child].key) {
+                break;
+            }
+            place(position, m_entries[child]);
+            position = child;
+        }
+        place(position, entry);
+    }
+
+    void IndexedHeap::place(int position, const Entry& entry) {
+        m_entries[position] = entry;
+        position_of(entry.index) = position;
+    }
+
+    void PathSearchContext::begin(int cell_count) {
+        const size_t pages = size_t(cell_count + PAGE_SIZE - 1) >> PAGE_BITS;
+        if (m_pages.size() < pages) {
+            m_pages.resize(pages);
+        }
+        m_open.resize(cell_count);
+        m_open.reserve(OPEN_CAPACITY); //Open lists stay far below the map size, the odd larger one grows the vector once
+        m_open.clear();
+        m_sequence = 0;
+
+        m_generation++;
+        if (m_generation == 0) { //Stamps wrapped around, start over from a clean slate
+            for (const auto& page : m_pages) {
+                for (int i = 0; page && i < PAGE_SIZE; i++) {
+                    page[i].m_stamp = 0;
+                    page[i].m_closed = 0;
+                }
+            }
+            m_generation = 1;
+        }
+    }
+
+    PathSearchContext::Node& PathSearchContext::node(int index) {
+        std::unique_ptr<Node[]>& page = m_pages[index >> PAGE_BITS];
+        if (!page) {
+            page = std::make_unique<Node[]>(PAGE_SIZE);
+        }
+        return page[index & (PAGE_SIZE - 1)];
+    }
+
+    void PathSearchContext::reach(int index, int g, int parent) {
+        Node& entry = node(index);
+        entry.m_stamp = m_generation;
+        entry.m_g = g;
+        entry.m_parent = parent;
+    }
+
+    PathSearchContext& search_context() {
+        thread_local PathSearchContext context;
+        return context;
+    }
+
+    namespace {
+        // note: open list ordered by fCost, ties resolved first-in first-out
+        uint64_t open_key(int fCost, uint32_t sequence) {
+            return (uint64_t(uint32_t(fCost)) << 32) | sequence;
+        }
+
+        constexpr Point DIRECTIONS[] = { {0, -1}, {0, 1}, {-1, 0}, {1, 0} };
+    }
+
     std::vector<Point> findPath(const World& world, const Point& start, const Point& goal) {
-        int gridWidth = world.m_world_size.x; //Get the map size
-        int gridHeight = world.m_world_size.y;
-        std::vector<Node> nodes(gridWidth * gridHeight);//Each tile corresponds to a node
+        return findPath(world, start, goal, world.m_path_algorithm);
+    }
 
+    std::vector<Point> findPath(const World& world, const Point& start, const Point& goal, PathAlgorithm algorithm) {
+        if (!world.m_components.reachable(start, goal)) { //Different regions, no need to flood ours to find out
+            return {};
+        }
+        switch (algorithm) {
+        case PathAlgorithm::JumpPoint:
+            return findPathJPS(world, start, goal);
+        case PathAlgorithm::Hierarchical:
+            return world.m_path_hierarchy.find_path(world, start, goal);
+        case PathAlgorithm::AStar:
+        default:
+            return findPathAStar(world, start, goal);
+        }
+    }
+
+    std::vector<Point> findPathAStar(const World& world, const Point& start, const Point& goal) {
+        std::vector<Point> path;
+        appendPathWithin(world, start, goal, Point(0, 0), world.m_world_size - Point(1, 1), path);
+        return path;
+    }
+
+    bool appendPathWithin(const World& world, const Point& start, const Point& goal, const Point& min, const Point& max, std::vector<Point>& path) {
+        auto inside = [&min, &max](const Point& p) {
+            return p.x >= min.x && p.y >= min.y && p.x <= max.x && p.y <= max.y;
+            };
+        if (!world.is_valid_coord(start) || !world.is_valid_coord(goal) || !inside(start) || !inside(goal)) {
+            return false;
+        }
+
+        const int gridWidth = world.m_world_size.x; //Get the map size
+        const int gridHeight = world.m_world_size.y;
         auto index = [gridWidth](const Point& p) -> int {
             return p.y * gridWidth + p.x;//Converts xy coordinates to a 1D index
             };
-        //Initialization
-        for (int y = 0; y < gridHeight; y++) {
-            for (int x = 0; x < gridWidth; x++) {
-                Node& node = nodes[y * gridWidth + x];
-                node.coord = Point(x, y);
-                node.walkable = world.is_walkable(node.coord);
-                node.gCost = std::numeric_limits<int>::max();
-                node.hCost = 0;
-                node.parent = nullptr;
-            }
-        }
-        //Obtain start and goal points and initialize the cost
-        Node* startNode = &nodes[index(start)];
-        Node* goalNode = &nodes[index(goal)];
-        startNode->gCost = 0;
-        startNode->hCost = heuristic(start, goal);
-
-        std::vector<Node*> openList;
-        std::vector<Node*> closedList;
-        openList.push_back(startNode);
-
-        while (!openList.empty()) { //Locate the node with the smallest fCost in openList
-            auto currentIt = std::min_element(openList.begin(), openList.end(),
-                [](Node* a, Node* b) {
-                    return a->fCost() < b->fCost();
-                });
-            Node* currentNode = *currentIt;
+
+        PathSearchContext& context = search_context();
+        context.begin(gridWidth * gridHeight);
+        IndexedHeap& openList = context.m_open;
+
+        const int startIndex = index(start);
+        const int goalIndex = index(goal);
+        context.reach(startIndex, 0, -1);
+        openList.push(startIndex, open_key(heuristic(start, goal), context.m_sequence++));
+
+        while (!openList.empty()) { //Take the node with the smallest fCost from openList
+            const int current = openList.pop();
             //A classical method for constructing least-cost paths
-            if (currentNode == goalNode) {
-                std::vector<Point> path;
-                while (currentNode != nullptr) {
-                    path.push_back(currentNode->coord);
-                    currentNode = currentNode->parent;
+            if (current == goalIndex) {
+                //When appending, the start tile is already the last tile of the existing path
+                const int skip = path.empty() ? 0 : 1;
+                const size_t offset = path.size();
+                path.resize(offset + context.g(current) + 1 - skip);
+                for (int node = current, i = (int)path.size() - 1; i >= (int)offset; node = context.parent(node), i--) {
+                    path[i] = Point(node % gridWidth, node / gridWidth);
                 }
-                std::reverse(path.begin(), path.end());
-                return path;
+                return true;
             }
 
-            openList.erase(currentIt); //openList removes the current node and adds it to closedList
-            closedList.push_back(currentNode);
+            context.close(current);
+            const Point currentCoord(current % gridWidth, current / gridWidth);
+            const int tentativeGCost = context.g(current) + 1;
             //Iterate four directions, simplifying A*
-            std::vector<Point> directions = { {0, -1}, {0, 1}, {-1, 0}, {1, 0} };
-            for (const auto& d : directions) {
-                Point neighborCoord = currentNode->coord + d;
-                if (neighborCoord.x < 0 || neighborCoord.y < 0 ||
-                    neighborCoord.x >= gridWidth || neighborCoord.y >= gridHeight)
+            for (const Point& d : DIRECTIONS) {
+                const Point neighborCoord = currentCoord + d;
+                if (!inside(neighborCoord))
                     continue;
-                Node* neighbor = &nodes[index(neighborCoord)];
+                const int neighbor = index(neighborCoord);
                 //Complies with the tile restrictions ingame
-                if (!neighbor->walkable ||
-                    std::find(closedList.begin(), closedList.end(), neighbor) != closedList.end())
+                if (context.is_closed(neighbor) || !world.m_walkable.test(neighborCoord))
                     continue;
 
-                int tentativeGCost = currentNode->gCost + 1;
+                const int fCost = tentativeGCost + heuristic(neighborCoord, goal);
+                if (!context.is_reached(neighbor)) {
+                    context.reach(neighbor, tentativeGCost, current);
+                    openList.push(neighbor, open_key(fCost, context.m_sequence++));
+                }
+                else if (tentativeGCost < context.g(neighbor)) {
+                    //Keep the original insertion order so ties resolve exactly as before
+                    const uint32_t sequence = uint32_t(openList.key_of(neighbor));
+                    context.reach(neighbor, tentativeGCost, current);
+                    openList.update(neighbor, open_key(fCost, sequence));
+                }
+            }
+        }
+        return false;
+    }
+
+    bool hasLineOfSight(const World& world, const Point& from, const Point& to) {
+        if (!world.is_valid_coord(from) || !world.is_valid_coord(to)) {
+            return false;
+        }
+        //Walk every tile the segment touches, in order (supercover grid traversal). They all lie in the
+        //box between two valid tiles, so the walkability bits are read without bounds checks
+        const WalkabilityGrid& walkable = world.m_walkable;
+        int dx = std::abs(to.x - from.x);
+        int dy = std::abs(to.y - from.y);
+        const int sx = to.x > from.x ? 1 : -1;
+        const int sy = to.y > from.y ? 1 : -1;
+        int error = dx - dy;
+        dx *= 2;
+        dy *= 2;
+        Point at = from;
+        for (int steps = std::abs(to.x - from.x) + std::abs(to.y - from.y); steps > 0; steps--) {
+            if (error > 0) {
+                at.x += sx;
+                error -= dy;
+            }
+            else if (error < 0) {
+                at.y += sy;
+                error += dx;
+            }
+            else { //Exactly through a corner, both tiles beside it have to be open
+                if (!walkable.test({ at.x + sx, at.y }) || !walkable.test({ at.x, at.y + sy })) {
+                    return false;
+                }
+                at.x += sx;
+                at.y += sy;
+                error += dx - dy;
+                steps--;
+            }
+            if (!walkable.test(at)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void smoothPath(const World& world, std::vector<Point>& path) {
+        if (path.size() < 3) {
+            return;
+        }
+        size_t kept = 0;
+        for (size_t i = 1; i + 1 < path.size(); i++) {
+            if (!hasLineOfSight(world, path[kept], path[i + 1])) {
+                path[++kept] = path[i];
+            }
+        }
+        path[++kept] = path.back();
+        path.resize(kept + 1);
+    }
 
-                if (tentativeGCost < neighbor->gCost ||
-                    std::find(openList.begin(), openList.end(), neighbor) == openList.end()) {
-                    neighbor->gCost = tentativeGCost;
-                    neighbor->hCost = heuristic(neighborCoord, goal);
-                    neighbor->parent = currentNode;
-                    if (std::find(openList.begin(), openList.end(), neighbor) == openList.end()) {
-                        openList.push_back(neighbor);
+    void JumpTable::rebuild(const World& world) {
+        m_size = world.m_world_size;
+        m_left.assign(m_size.x * m_size.y, 0);
+        m_right.assign(m_size.x * m_size.y, 0);
+        rebuild_rows(world, 0, m_size.y - 1);
+    }
+
+    void JumpTable::rebuild_rows(const World& world, int first_row, int last_row) {
+        first_row = Math::max(first_row, 0);
+        last_row = Math::min(last_row, m_size.y - 1);
+        const WalkabilityGrid& walkable = world.m_walkable;
+        const int words = (m_size.x + 63) / 64;
+        std::vector<uint64_t> open_right(words), forced_right(words), open_left(words), forced_left(words);
+        auto bit = [](const std::vector<uint64_t>& mask, int x) { return ((mask[x >> 6] >> (x & 63)) & 1) != 0; };
+        for (int y = first_row; y <= last_row; y++) {
+            //Moving horizontally into the next tile, one of its vertical neighbours is forced when the
+            //matching neighbour of the tile left behind is blocked (vertical moves are taken first).
+            //Worked out for 64 tiles at a time straight from the walkability bits
+            for (int w = 0; w < words; w++) {
+                const int x = w * 64;
+                const uint64_t above = walkable.row_bits(x, y - 1);
+                const uint64_t below = walkable.row_bits(x, y + 1);
+                open_right[w] = walkable.row_bits(x + 1, y);
+                forced_right[w] = (walkable.row_bits(x + 1, y - 1) & ~above) | (walkable.row_bits(x + 1, y + 1) & ~below);
+                open_left[w] = walkable.row_bits(x - 1, y);
+                forced_left[w] = (walkable.row_bits(x - 1, y - 1) & ~above) | (walkable.row_bits(x - 1, y + 1) & ~below);
+            }
+
+            int16_t* left = m_left.data() + y * m_size.x;
+            int16_t* right = m_right.data() + y * m_size.x;
+            //Sweep against the direction of travel so each tile extends its neighbour's distance
+            for (int x = m_size.x - 1; x >= 0; x--) {
+                if (!bit(open_right, x)) {
+                    right[x] = 0;
+                }
+                else if (bit(forced_right, x)) {
+                    right[x] = 1;
+                }
+                else {
+                    right[x] = int16_t(right[x + 1] > 0 ? right[x + 1] + 1 : right[x + 1] - 1);
+                }
+            }
+            for (int x = 0; x < m_size.x; x++) {
+                if (!bit(open_left, x)) {
+                    left[x] = 0;
+                }
+                else if (bit(forced_left, x)) {
+                    left[x] = 1;
+                }
+                else {
+                    left[x] = int16_t(left[x - 1] > 0 ? left[x - 1] + 1 : left[x - 1] - 1);
+                }
+            }
+        }
+    }
+
+    namespace {
+        struct JumpSearch {
+            const World& world;
+            const JumpTable& table;
+            Point goal;
+            int width;
+
+            // note: returns the jump point reached by moving horizontally from `from`, or -1
+            int jump_horizontal(const Point& from, int dx) const {
+                const int distance = table.distance(from.y * width + from.x, dx);
+                if (goal.y == from.y && (goal.x - from.x) * dx > 0 && abs(goal.x - from.x) <= abs(distance)) {
+                    return goal.y * width + goal.x;
+                }
+                if (distance > 0) {
+                    return from.y * width + from.x + distance * dx;
+                }
+                return -1;
+            }
+
+            // note: a vertical run stops on any tile whose horizontal sweep leads somewhere
+            int jump_vertical(const Point& from, int dy) const {
+                Point current = from;
+                while (true) {
+                    current.y += dy;
+                    if (!world.m_walkable.test(current)) { //Stops on the blocked border at the latest
+                        return -1;
+                    }
+                    const int index = current.y * width + current.x;
+                    if (current == goal) {
+                        return index;
+                    }
+                    if (jump_horizontal(current, -1) != -1 || jump_horizontal(current, 1) != -1) {
+                        return index;
                     }
                 }
             }
+        };
+    }
+
+    std::vector<Point> findPathJPS(const World& world, const Point& start, const Point& goal) {
+        if (!world.is_valid_coord(start) || !world.is_valid_coord(goal)) {
+            return std::vector<Point>();
+        }
+        if (!world.is_walkable(goal) && !(start == goal)) {
+            return std::vector<Point>();
+        }
+
+        const int gridWidth = world.m_world_size.x;
+        const JumpSearch search{ world, world.m_jump_table, goal, gridWidth };
+        auto coord = [gridWidth](int index) -> Point {
+            return Point(index % gridWidth, index / gridWidth);
+            };
+
+        PathSearchContext& context = search_context();
+        context.begin(gridWidth * world.m_world_size.y);
+        IndexedHeap& openList = context.m_open;
+
+        const int startIndex = start.y * gridWidth + start.x;
+        const int goalIndex = goal.y * gridWidth + goal.x;
+        context.reach(startIndex, 0, -1);
+        openList.push(startIndex, open_key(heuristic(start, goal), context.m_sequence++));
+
+        int successors[4];
+        while (!openList.empty()) {
+            const int current = openList.pop();
+            if (current == goalIndex) {
+                //Unfold the straight segments between jump points back into single tile steps
+                std::vector<Point> path(context.g(current) + 1);
+                int i = (int)path.size() - 1;
+                for (int node = current; node != -1; node = context.parent(node)) {
+                    const Point to = coord(node);
+                    const int parent = context.parent(node);
+                    const Point from = parent == -1 ? to : coord(parent);
+                    const Point step{ Math::sign(from.x - to.x), Math::sign(from.y - to.y) };
+                    for (Point p = to; !(p == from); p = p + step) {
+                        path[i--] = p;
+                    }
+                    if (parent == -1) {
+                        path[i--] = to;
+                    }
+                }
+                return path;
+            }
+
+            context.close(current);
+            const Point currentCoord = coord(current);
+            int count = 0;
+            const int parent = context.parent(current);
+            if (parent == -1) {
+                successors[count++] = search.jump_vertical(currentCoord, -1);
+                successors[count++] = search.jump_vertical(currentCoord, 1);
+                successors[count++] = search.jump_horizontal(currentCoord, -1);
+                successors[count++] = search.jump_horizontal(currentCoord, 1);
+            }
+            else {
+                const Point parentCoord = coord(parent);
+                const int dx = Math::sign(currentCoord.x - parentCoord.x);
+                const int dy = Math::sign(currentCoord.y - parentCoord.y);
+                if (dy != 0) { //Vertical arrivals branch out both ways horizontally
+                    successors[count++] = search.jump_vertical(currentCoord, dy);
+                    successors[count++] = search.jump_horizontal(currentCoord, -1);
+                    successors[count++] = search.jump_horizontal(currentCoord, 1);
+                }
+                else { //Horizontal arrivals only turn where the tile behind was blocked
+                    const Point behind{ currentCoord.x - dx, currentCoord.y };
+                    successors[count++] = search.jump_horizontal(currentCoord, dx);
+                    if (world.m_walkable.test({ currentCoord.x, currentCoord.y - 1 }) && !world.m_walkable.test({ behind.x, behind.y - 1 })) {
+                        successors[count++] = search.jump_vertical(currentCoord, -1);
+                    }
+                    if (world.m_walkable.test({ currentCoord.x, currentCoord.y + 1 }) && !world.m_walkable.test({ behind.x, behind.y + 1 })) {
+                        successors[count++] = search.jump_vertical(currentCoord, 1);
+                    }
+                }
+            }
+
+            for (int s = 0; s < count; s++) {
+                const int successor = successors[s];
+                if (successor == -1 || context.is_closed(successor)) {
+                    continue;
+                }
+                const Point successorCoord = coord(successor);
+                const int tentativeGCost = context.g(current) + heuristic(currentCoord, successorCoord);
+                const int fCost = tentativeGCost + heuristic(successorCoord, goal);
+                if (!context.is_reached(successor)) {
+                    context.reach(successor, tentativeGCost, current);
+                    openList.push(successor, open_key(fCost, context.m_sequence++));
+                }
+                else if (tentativeGCost < context.g(successor)) {
+                    const uint32_t sequence = uint32_t(openList.key_of(successor));
+                    context.reach(successor, tentativeGCost, current);
+                    openList.update(successor, open_key(fCost, sequence));
+                }
+            }
         }
         return std::vector<Point>();
     }
 } // namespace sim
-
@@ -0,0 +1,25 @@
+// random.cpp
+
+#include "random.hpp"
+
+namespace sim
+{
+    uint64_t Random::next()
+    {
+        uint64_t z = (m_state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    int Random::range(int min, int max)
+    {
+        if (min > max) {
+            const int swap = min;
+            min = max;
+            max = swap;
+        }
+        const uint64_t span = uint64_t(int64_t(max) - int64_t(min)) + 1;
+        return int(int64_t(min) + int64_t(next() % span));
+    }
+}
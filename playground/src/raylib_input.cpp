@@ -0,0 +1,20 @@
+// raylib_input.cpp
+
+#include "input_source.hpp"
+
+namespace sim
+{
+    bool RaylibInput::quit_requested() const
+    {
+        return IsKeyReleased(KEY_ESCAPE);
+    }
+
+    bool RaylibInput::move_requested(Vector2& position) const
+    {
+        if (!IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+            return false;
+        }
+        position = GetMousePosition();
+        return true;
+    }
+}
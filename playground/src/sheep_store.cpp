@@ -0,0 +1,494 @@
+// sheep_store.cpp
+
+#include "sheep_store.hpp"
+#include "entity.hpp"
+#include "fixed_step.hpp"
+#include "world.hpp"
+#include <algorithm>
+
+namespace sim
+{
+    void SheepStore::reserve(int capacity)
+    {
+        m_position.reserve(capacity);
+        m_previous_position.reserve(capacity);
+        m_direction.reserve(capacity);
+        m_state.reserve(capacity);
+        m_hp.reserve(capacity);
+        m_hunger.reserve(capacity);
+        m_decision_ticks.reserve(capacity);
+        m_reproduce_timer.reserve(capacity);
+        m_cooldown.reserve(capacity);
+        m_eating_timer.reserve(capacity);
+        m_satiety_timer.reserve(capacity);
+        m_full.reserve(capacity);
+        m_found_grass.reserve(capacity);
+        m_wolf_nearby.reserve(capacity);
+        m_nearest_wolf.reserve(capacity);
+        m_flip_x.reserve(capacity);
+        m_radius.reserve(capacity);
+        m_cold.reserve(capacity);
+    }
+
+    int SheepStore::spawn(const Vector2& position, const Vector2& direction, float radius)
+    {
+        const int index = size();
+        m_position.push_back(position);
+        m_previous_position.push_back(position);
+        m_direction.push_back(direction);
+        m_state.push_back(SheepState::WANDERING);
+        m_hp.push_back(SHEEP_MAX_HP);
+        m_hunger.push_back(0.0f);
+        m_decision_ticks.push_back(0);
+        m_reproduce_timer.push_back(0.0f);
+        m_cooldown.push_back(Sheep::REPRODUCTION_COOLDOWN_TIME);
+        m_eating_timer.push_back(0.0f);
+        m_satiety_timer.push_back(0.0f);
+        m_full.push_back(0);
+        m_found_grass.push_back(0);
+        m_wolf_nearby.push_back(0);
+        m_nearest_wolf.push_back(Vector2{});
+        m_flip_x.push_back(0);
+        m_radius.push_back(radius);
+        m_cold.emplace_back();
+        m_handles.create(index);
+        return index;
+    }
+
+    void SheepStore::remove_dead()
+    {
+        const int count = size();
+        std::vector<int> remap(count, Sheep::NONE);
+        int kept = 0;
+        for (int i = 0; i < count; i++) {
+            if (m_state[i] == SheepState::DEAD) {
+                continue;
+            }
+            remap[i] = kept;
+            if (kept != i) {
+                m_position[kept] = m_position[i];
+                m_previous_position[kept] = m_previous_position[i];
+                m_direction[kept] = m_direction[i];
+                m_state[kept] = m_state[i];
+                m_hp[kept] = m_hp[i];
+                m_hunger[kept] = m_hunger[i];
+                m_decision_ticks[kept] = m_decision_ticks[i];
+                m_reproduce_timer[kept] = m_reproduce_timer[i];
+                m_cooldown[kept] = m_cooldown[i];
+                m_eating_timer[kept] = m_eating_timer[i];
+                m_satiety_timer[kept] = m_satiety_timer[i];
+                m_full[kept] = m_full[i];
+                m_found_grass[kept] = m_found_grass[i];
+                m_wolf_nearby[kept] = m_wolf_nearby[i];
+                m_nearest_wolf[kept] = m_nearest_wolf[i];
+                m_flip_x[kept] = m_flip_x[i];
+                m_radius[kept] = m_radius[i];
+                m_cold[kept] = std::move(m_cold[i]);
+            }
+            kept++;
+        }
+
+        m_position.resize(kept);
+        m_previous_position.resize(kept);
+        m_direction.resize(kept);
+        m_state.resize(kept);
+        m_hp.resize(kept);
+        m_hunger.resize(kept);
+        m_decision_ticks.resize(kept);
+        m_reproduce_timer.resize(kept);
+        m_cooldown.resize(kept);
+        m_eating_timer.resize(kept);
+        m_satiety_timer.resize(kept);
+        m_full.resize(kept);
+        m_found_grass.resize(kept);
+        m_wolf_nearby.resize(kept);
+        m_nearest_wolf.resize(kept);
+        m_flip_x.resize(kept);
+        m_radius.resize(kept);
+        m_cold.resize(kept);
+
+        m_handles.compact(remap);
+        for (Cold& cold : m_cold) { //Suitors are indices, only good for the tick they were found in
+            cold.m_suitor = Sheep::NONE;
+        }
+    }
+
+    void SheepStore::update(World& world, int begin, int end, float dt)
+    {
+        const Rectangle& bounds = world.m_world_bounds;
+        for (int i = begin; i < end; i++) {
+            update(world, i, dt);
+
+            //Keep inside the world, bouncing off its edges
+            const float radius = m_radius[i];
+            Vector2& position = m_position[i];
+            Vector2& direction = m_direction[i];
+            if (position.x < bounds.x + radius) {
+                position.x = bounds.x + radius;
+                direction.x = -direction.x;
+            }
+            if (position.x > bounds.x + bounds.width - radius) {
+                position.x = bounds.x + bounds.width - radius;
+                direction.x = -direction.x;
+            }
+            if (position.y < bounds.y + radius) {
+                position.y = bounds.y + radius;
+                direction.y = -direction.y;
+            }
+            if (position.y > bounds.y + bounds.height - radius) {
+                position.y = bounds.y + bounds.height - radius;
+                direction.y = -direction.y;
+            }
+            world.m_sheep_hash.move(i, position);
+        }
+    }
+
+    void SheepStore::update(World& world, int i, float dt)
+    {
+        if (m_state[i] == SheepState::DEAD) return; //Death is no longer updated
+
+        if (m_cooldown[i] > 0.0f) {
+            m_cooldown[i] -= dt;
+        }
+
+        //Control the timer to influence whether or not to seek again
+        if (m_full[i]) {
+            m_satiety_timer[i] -= dt;
+            if (m_satiety_timer[i] <= 0.0f) {
+                m_full[i] = 0;
+            }
+        }
+
+        //Moving and the timers advance every tick, looking around and deciding only every few ticks depending on the state
+        const float decisionInterval = m_state[i] == SheepState::WANDERING ? 0.03f : 0.02f;
+        if (++m_decision_ticks[i] >= FixedStep::ticks_for(decisionInterval, dt)) {
+            m_decision_ticks[i] = 0;
+            //Perceive wolves or grass, and determine state changes
+            sense(world, i);
+            //If were in the grazing state, the eating behavior is completed first
+            if (m_state[i] != SheepState::EATING) {
+                decide(world, i);
+            }
+        }
+
+        if (m_state[i] == SheepState::EATING) {
+            act(world, i, dt);
+            return;
+        }
+        //If seeking for grass, follow the path
+        Path& path = m_cold[i].m_path;
+        if (m_state[i] == SheepState::SEEKING && !path.empty()) {
+            Vector2 nextPos = world.tile_coord_to_position(path.front());
+            float dist = Vector2Distance(m_position[i], nextPos);
+
+            if (dist < 5.0f) {
+                path.advance();// Short-distance scenario, encounters on the way are paired by World::match_partners
+            }
+            else {
+                m_direction[i] = Vector2Normalize(Vector2Subtract(nextPos, m_position[i]));
+                m_position[i] = Vector2Add(m_position[i], Vector2Scale(m_direction[i], Sheep::WALKING_SPEED * dt));
+            }
+        }
+        else if (m_state[i] != SheepState::SEEKING) {
+            Vector2 velocity = Vector2Scale(m_direction[i], Sheep::WALKING_SPEED * dt);
+            m_position[i] = Vector2Add(m_position[i], velocity);
+        }
+
+        m_flip_x[i] = m_direction[i].x > 0.0f;
+        act(world, i, dt);
+        //Hunger accumulates, and blood lost if too hungry
+        m_hunger[i] += dt;
+        if (m_hunger[i] > 10.0f && m_state[i] != SheepState::REPRODUCE) {
+            m_hp[i] -= static_cast<int>(SHEEP_HUNGER_HP_LOSS * dt / 2.0f);
+            if (m_hp[i] <= 0) {
+                m_hp[i] = 0;
+                m_state[i] = SheepState::DEAD;
+                world.m_commands.despawn_sheep(handle(i));
+            }
+        }
+    }
+
+    void SheepStore::sense(World& world, int i)
+    {
+        m_found_grass[i] = 0;
+        m_wolf_nearby[i] = 0;
+        m_nearest_wolf[i] = { 0, 0 };
+
+        //Only the tile underneath can have its centre within half a tile of us
+        Point tile = world.position_to_tile_coord(m_position[i]);
+        if (world.has_grass_at(tile)) {
+            Vector2 grassPos = world.tile_coord_to_position(tile);
+            m_found_grass[i] = Vector2Distance(m_position[i], grassPos) < (world.m_tile_size.x / 2.0f);
+        }
+
+        world.nearest_wolves(m_position[i], 100.0f, 1, m_neighbours);
+        if (!m_neighbours.empty()) {
+            m_nearest_wolf[i] = world.m_wolf[m_neighbours.front()].m_position;
+            m_wolf_nearby[i] = 1;
+        }
+    }
+
+    void SheepStore::decide(World& world, int i)
+    {
+        Cold& cold = m_cold[i];
+        world.claim_path(cold.m_path_ticket, cold.m_path);
+        if (m_state[i] == SheepState::REPRODUCE) return; // note: pairs are made once per tick by World::match_partners
+
+        if (m_wolf_nearby[i]) {
+            m_state[i] = SheepState::ESCAPING;
+            cold.m_path.clear();
+            return;
+        }
+
+        if (m_full[i]) {
+            m_state[i] = SheepState::WANDERING;
+            cold.m_path.clear();
+            return;
+        }
+
+        Point currentTile = world.position_to_tile_coord(m_position[i]);
+        bool grassHere = world.has_grass_at(currentTile);
+        if (grassHere) {
+            m_state[i] = SheepState::EATING;
+            m_eating_timer[i] = 0.0f;
+            cold.m_path.clear();
+
+            m_position[i] = world.tile_coord_to_position(currentTile);
+            m_direction[i] = { 0,0 };
+            return;
+        }
+
+        if (m_hunger[i] > 5.0f) {
+            m_state[i] = SheepState::SEEKING;
+            if (cold.m_path.empty()) { //Take the next step of the shared grass flow field instead of searching
+                Point next;
+                if (!world.m_grass_field.next_step(currentTile, next)) {
+                    m_state[i] = SheepState::WANDERING;
+                    return;
+                }
+                cold.m_path.push_back(world.m_path_arena, next);
+            }
+            if (!cold.m_path.empty()) {
+                Vector2 nextPos = world.tile_coord_to_position(cold.m_path.front());
+                float dist = Vector2Distance(m_position[i], nextPos);
+                if (dist < 8.0f) { //Walking there is left to update, which moves every tick
+                    cold.m_path.advance();
+                    if (cold.m_path.empty()) {
+                        Point newTile = world.position_to_tile_coord(m_position[i]);
+                        if (world.has_grass_at(newTile)) {
+                            m_state[i] = SheepState::EATING;
+                            return;
+                        }
+                    }
+                }
+            }
+        }
+        else {
+            if (!m_full[i] && m_cooldown[i] <= 0.0f && m_hp[i] >= REPRODUCE_HP_THRESHOLD) {
+                Point start = currentTile;
+                Point partnerTile = start;
+                if (cold.m_suitor != Sheep::NONE) { //Walk towards the partner matchmaking found for us
+                    partnerTile = world.position_to_tile_coord(m_position[cold.m_suitor]);
+                }
+
+                if (cold.m_suitor != Sheep::NONE && (partnerTile.x != start.x || partnerTile.y != start.y)) {
+                    if (world.is_walkable(partnerTile)) {
+                        if (cold.m_path_ticket == 0) {
+                            cold.m_path_ticket = world.request_path(start, partnerTile);
+                        }
+                        if (!cold.m_path.empty()) { //Keep to the last route while the next one is being searched
+                            m_state[i] = SheepState::SEEKING;
+                            return;
+                        }
+                    }
+                }
+            }
+            m_state[i] = SheepState::WANDERING;
+        }
+    }
+
+    void SheepStore::act(World& world, int i, float dt)
+    {
+        switch (m_state[i])
+        {
+            case SheepState::WANDERING:
+            { //Sheep in wander state might follow other sheep, imitating the group behaviour
+                constexpr float FOLLOW_RADIUS = 150.0f;
+                constexpr int FOLLOW_CHANCE_PERCENT = 30; // 30% following potential other sheep
+
+                bool followed = false;
+                if (world.m_random.range(0, 100) < FOLLOW_CHANCE_PERCENT) { // find the nearest sheep to follow with
+                    world.nearest_sheep(m_position[i], FOLLOW_RADIUS, 2, m_neighbours); // note: one of the two may be this sheep
+                    for (int other : m_neighbours) {
+                        if (other == i) continue;
+                        Vector2 dirToOther = Vector2Normalize(Vector2Subtract(m_position[other], m_position[i]));
+                        m_position[i] = Vector2Add(m_position[i], Vector2Scale(dirToOther, Sheep::WALKING_SPEED * dt));
+                        followed = true;
+                        break;
+                    }
+                }
+
+                if (!followed) {
+                    Vector2 randomDir = { (float)world.m_random.range(-100, 100) / 100.0f, (float)world.m_random.range(-100, 100) / 100.0f };
+                    randomDir = Vector2Normalize(randomDir);
+                    m_position[i] = Vector2Add(m_position[i], Vector2Scale(randomDir, Sheep::WALKING_SPEED * dt));
+                }
+
+                if (m_hunger[i] > 10.0f) {
+                    m_state[i] = SheepState::SEEKING;
+                }
+                m_eating_timer[i] = 0.0f;
+                break;
+            }
+            case SheepState::SEEKING:
+            {
+                if (m_found_grass[i]) {
+                    m_state[i] = SheepState::EATING;
+                    m_eating_timer[i] = 0.0f; // Sheep starts eating
+                }
+                break;
+            }
+            case SheepState::EATING:
+            {
+                if (m_wolf_nearby[i]) {
+                    m_state[i] = SheepState::ESCAPING;
+                    return;
+                }
+
+                m_eating_timer[i] += dt;
+                if (m_eating_timer[i] >= 3.0f)
+                {
+                    m_hp[i] = std::min(m_hp[i] + SHEEP_HEAL_AMOUNT, SHEEP_MAX_HP);
+
+                    Point tileCoord = world.position_to_tile_coord(m_position[i]);
+
+                    if (world.has_grass_at(tileCoord) &&
+                        Vector2Distance(m_position[i], world.tile_coord_to_position(tileCoord)) < (world.m_tile_size.x / 2.0f)) {
+                        world.m_grass.eat(tileCoord);
+                        world.on_grass_changed(tileCoord);
+
+                        if (Manure* newManure = world.m_manure.spawn(&world, tileCoord)) { //At most one manure per tile
+                            newManure->set_position(world.tile_coord_to_position(tileCoord));
+                            newManure->set_duration(5.0f);
+                            newManure->set_quality((float)world.m_random.range(1, 5));
+                        }
+                        m_found_grass[i] = 0;
+                    }
+
+                    m_hunger[i] = 0;
+                    m_eating_timer[i] = 0.0f;
+
+                    m_full[i] = 1;
+                    m_satiety_timer[i] = Sheep::FULL_DURATION;
+
+                    m_cold[i].m_path.clear();
+                    m_state[i] = SheepState::WANDERING;
+
+                    m_direction[i] = Vector2Normalize({
+            (float)world.m_random.range(-100, 100) / 100.0f,
+            (float)world.m_random.range(-100, 100) / 100.0f
+                        });
+                }
+                return;
+            }
+            case SheepState::ESCAPING:
+            {
+                if (m_wolf_nearby[i]) {
+                    Vector2 fleeDir = Vector2Subtract(m_position[i], m_nearest_wolf[i]);
+                    fleeDir = Vector2Normalize(fleeDir);
+                    m_position[i] = Vector2Add(m_position[i], Vector2Scale(fleeDir, Sheep::RUNNING_SPEED * dt));
+                }
+                else {
+                    m_state[i] = SheepState::WANDERING;
+                }
+                break;
+            }
+
+            case SheepState::REPRODUCE:
+            {
+                if (m_wolf_nearby[i]) {
+                    m_state[i] = SheepState::ESCAPING;
+                    break;
+                }
+                const int partner = resolve(m_cold[i].m_partner); // note: NONE once the partner was swept
+
+                if (partner == Sheep::NONE) {
+                    m_state[i] = SheepState::WANDERING;
+                    m_reproduce_timer[i] = 0.0f;
+                    break;
+                }
+                m_reproduce_timer[i] -= dt;
+                m_position[i].x += (float)world.m_random.range(-2, 2);
+                m_position[i].y += (float)world.m_random.range(-2, 2);//Small movement to reduce the frame movement results
+
+                //Avoid stuck
+                constexpr float REPRODUCTION_TIMEOUT = -2.0f;
+                if (m_reproduce_timer[i] < REPRODUCTION_TIMEOUT) {
+                    m_state[i] = SheepState::WANDERING;
+                    m_reproduce_timer[i] = 0.0f;
+                    m_cold[i].m_partner = Handle{};
+                    break;
+                }
+
+                if (m_reproduce_timer[i] <= 0.0f)
+                {
+                    if (m_cold[i].m_bears_lamb && m_state[partner] == SheepState::REPRODUCE)
+                    {
+                        m_hp[i] -= REPRODUCE_HP_COST;
+                        m_hp[partner] -= REPRODUCE_HP_COST;
+                        m_cooldown[i] = Sheep::REPRODUCTION_COOLDOWN_TIME;
+                        m_cooldown[partner] = Sheep::REPRODUCTION_COOLDOWN_TIME;
+                        m_cold[partner].m_partner = Handle{};
+                        m_state[partner] = SheepState::WANDERING;
+                        m_reproduce_timer[partner] = 0.0f;
+
+                        Vector2 newPos = Vector2Scale(Vector2Add(m_position[i], m_position[partner]), 0.5f);
+                        world.m_commands.spawn_sheep({ newPos, { 1, 0 }, m_radius[i], m_cold[i].m_source, m_cold[i].m_origin });
+                    }
+                    m_state[i] = SheepState::WANDERING;
+                    m_reproduce_timer[i] = 0.0f;
+                    m_cold[i].m_partner = Handle{};
+                }
+                return;
+            }
+            case SheepState::DEAD:
+                 return;
+        }
+        m_hunger[i] += dt;
+    }
+
+    bool SheepStore::ready_to_mate(int i) const
+    {
+        return m_state[i] != SheepState::DEAD && m_state[i] != SheepState::REPRODUCE && !m_wolf_nearby[i] &&
+               m_hp[i] >= REPRODUCE_HP_THRESHOLD && m_cooldown[i] <= 0.0f;
+    }
+
+    void SheepStore::pair(int i, const Handle& partner, bool bears_lamb)
+    {
+        m_state[i] = SheepState::REPRODUCE;
+        m_reproduce_timer[i] = REPRODUCTION_PAUSE_TIME;
+        m_cold[i].m_partner = partner;
+        m_cold[i].m_bears_lamb = bears_lamb;
+    }
+
+    void SheepStore::get_eaten(int i)
+    {
+        m_state[i] = SheepState::DEAD;
+    }
+
+    void SheepStore::recalculate_path(World& world, int i)
+    {
+        //The route recalculation function is used to call when the map is changed or the state is switched
+        Cold& cold = m_cold[i];
+        Point start = world.position_to_tile_coord(m_position[i]);
+        Point goal = world.findNearestGrass(start);
+
+        world.cancel_path(cold.m_path_ticket);
+        if (goal.x >= 0 && goal.y >= 0 && world.is_walkable(goal)) {
+            cold.m_path_ticket = world.request_path(start, goal);
+        }
+        else {
+            cold.m_path.clear();
+        }
+    }
+}
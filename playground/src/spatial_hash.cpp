@@ -0,0 +1,60 @@
+// spatial_hash.cpp
+
+#include "spatial_hash.hpp"
+
+namespace sim
+{
+    void SpatialHash::reset(const Point& origin, const Point& cells, int cell_size)
+    {
+        clear();
+        m_origin = origin;
+        m_cells = Point(std::max(cells.x, 1), std::max(cells.y, 1));
+        m_cell_size = std::max(cell_size, 1);
+        m_buckets.resize(size_t(m_cells.x) * size_t(m_cells.y));
+    }
+
+    void SpatialHash::clear()
+    {
+        for (int cell : m_cell_of) { //Only the occupied buckets, the grid can be far larger than the crowd
+            m_buckets[cell].clear();
+        }
+        m_cell_of.clear();
+    }
+
+    void SpatialHash::insert(int id, const Vector2& position)
+    {
+        const int cell = cell_index(cell_coord(position));
+        m_cell_of.resize(std::max<size_t>(m_cell_of.size(), size_t(id) + 1), cell);
+        m_cell_of[id] = cell;
+        m_buckets[cell].push_back(id);
+    }
+
+    void SpatialHash::move(int id, const Vector2& position)
+    {
+        const int cell = cell_index(cell_coord(position));
+        const int old = m_cell_of[id];
+        if (cell == old) {
+            return;
+        }
+        std::vector<int>& bucket = m_buckets[old];
+        auto it = std::find(bucket.begin(), bucket.end(), id);
+        *it = bucket.back();
+        bucket.pop_back();
+        m_buckets[cell].push_back(id);
+        m_cell_of[id] = cell;
+    }
+
+    Point SpatialHash::cell_coord(const Vector2& position) const
+    {
+        Point result = position;
+        result = result - m_origin;
+        result.x = std::clamp(result.x / m_cell_size, 0, m_cells.x - 1);
+        result.y = std::clamp(result.y / m_cell_size, 0, m_cells.y - 1);
+        return result;
+    }
+
+    int SpatialHash::max_ring(const Point& cell) const
+    {
+        return std::max(std::max(cell.x, m_cells.x - 1 - cell.x), std::max(cell.y, m_cells.y - 1 - cell.y));
+    }
+}
@@ -0,0 +1,89 @@
+// thread_pool.cpp
+
+#include "thread_pool.hpp"
+#include <algorithm>
+
+namespace sim
+{
+    ThreadPool::ThreadPool(int workers)
+    {
+        for (int i = 0; i < workers; i++) {
+            m_workers.emplace_back(&ThreadPool::worker_loop, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& worker : m_workers) {
+            worker.join();
+        }
+    }
+
+    int ThreadPool::default_worker_count()
+    {
+        // note: leave the calling thread out, it takes part in every loop anyway
+        const int hardware = (int)std::thread::hardware_concurrency();
+        return std::clamp(hardware - 1, 0, 15);
+    }
+
+    void ThreadPool::parallel_for(int count, const std::function<void(int)>& job)
+    {
+        if (count <= 0) {
+            return;
+        }
+        if (m_workers.empty() || count == 1) {
+            for (int i = 0; i < count; i++) {
+                job(i);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_job = &job;
+            m_count = count;
+            m_next = 0;
+            m_busy = (int)m_workers.size();
+            m_round++;
+        }
+        m_wake.notify_all();
+        run_jobs();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_busy == 0; });
+        m_job = nullptr;
+    }
+
+    void ThreadPool::worker_loop()
+    {
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this, seen] { return m_stopping || m_round != seen; });
+                if (m_stopping) {
+                    return;
+                }
+                seen = m_round;
+            }
+            run_jobs();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_busy--;
+            }
+            m_done.notify_one();
+        }
+    }
+
+    void ThreadPool::run_jobs()
+    {
+        for (int i = m_next.fetch_add(1); i < m_count; i = m_next.fetch_add(1)) {
+            (*m_job)(i);
+        }
+    }
+}
@@ -0,0 +1,86 @@
+// timing_wheel.cpp
+
+#include "timing_wheel.hpp"
+
+namespace sim
+{
+    void TimingWheel::reset(uint64_t tick)
+    {
+        for (auto& level : m_slots) {
+            for (auto& slot : level) {
+                slot.clear();
+            }
+        }
+        m_overflow.clear();
+        m_late.clear();
+        m_tick = tick;
+        m_size = 0;
+    }
+
+    void TimingWheel::schedule(uint64_t tick, const Event& event)
+    {
+        m_size++;
+        if (tick <= m_tick) {
+            m_late.push_back(event);
+            return;
+        }
+        place(tick, event);
+    }
+
+    void TimingWheel::place(uint64_t tick, const Event& event)
+    {
+        const uint64_t delta = tick - m_tick;
+        for (int level = 0; level < LEVELS; level++) {
+            if (delta < (uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+                m_slots[level][(tick >> (SLOT_BITS * level)) & (SLOTS - 1)].push_back(Entry{ tick, event });
+                return;
+            }
+        }
+        m_overflow.push_back(Entry{ tick, event });
+    }
+
+    void TimingWheel::cascade(int level)
+    {
+        //Re-place the entries of the slot the current tick just entered, they land in finer rings
+        std::vector<Entry>& slot = level < LEVELS
+            ? m_slots[level][(m_tick >> (SLOT_BITS * level)) & (SLOTS - 1)]
+            : m_overflow;
+        m_scratch.swap(slot);
+        slot.clear();
+        for (const Entry& entry : m_scratch) {
+            if (entry.m_tick <= m_tick) {
+                m_late.push_back(entry.m_event);
+            }
+            else {
+                place(entry.m_tick, entry.m_event);
+            }
+        }
+        m_scratch.clear();
+    }
+
+    void TimingWheel::advance(uint64_t tick, std::vector<Event>& due)
+    {
+        due.insert(due.end(), m_late.begin(), m_late.end());
+        m_size -= m_late.size();
+        m_late.clear();
+
+        while (m_tick < tick) {
+            m_tick++;
+            for (int level = LEVELS; level > 0; level--) { //Coarsest first so entries can fall through every ring
+                if ((m_tick & ((uint64_t(1) << (SLOT_BITS * level)) - 1)) == 0) {
+                    cascade(level);
+                }
+            }
+            std::vector<Entry>& slot = m_slots[0][m_tick & (SLOTS - 1)];
+            for (const Entry& entry : slot) {
+                due.push_back(entry.m_event);
+            }
+            m_size -= slot.size();
+            slot.clear();
+
+            due.insert(due.end(), m_late.begin(), m_late.end());
+            m_size -= m_late.size();
+            m_late.clear();
+        }
+    }
+}
@@ -0,0 +1,71 @@
+// walkability_grid.cpp
+
+#include "walkability_grid.hpp"
+#include <bit>
+
+namespace sim
+{
+    void WalkabilityGrid::reset(const Point& size, bool walkable)
+    {
+        m_size = size;
+        m_stride = (size.x + 2 * PADDING + 63) / 64 + 1;
+        m_words.assign(size_t(m_stride) * size_t(size.y + 2 * PADDING), 0);
+        if (!walkable) {
+            return;
+        }
+        for (int y = 0; y < size.y; y++) {
+            for (int x = 0; x < size.x; x += 64) {
+                const int count = Math::min(64, size.x - x);
+                const uint64_t run = count == 64 ? ~uint64_t(0) : (uint64_t(1) << count) - 1;
+                //A run of up to 64 tiles straddles at most two words
+                const int column = x + PADDING;
+                const int word = word_index(column, y);
+                m_words[word] |= run << (column & 63);
+                if (column & 63) {
+                    m_words[word + 1] |= run >> (64 - (column & 63));
+                }
+            }
+        }
+    }
+
+    void WalkabilityGrid::set(const Point& coord, bool walkable)
+    {
+        const int column = coord.x + PADDING;
+        const uint64_t bit = uint64_t(1) << (column & 63);
+        uint64_t& word = m_words[word_index(column, coord.y)];
+        word = walkable ? (word | bit) : (word & ~bit);
+    }
+
+    uint64_t WalkabilityGrid::row_bits(int x, int y) const
+    {
+        const int column = x + PADDING;
+        const int word = word_index(column, y);
+        const int shift = column & 63;
+        if (shift == 0) {
+            return m_words[word];
+        }
+        return (m_words[word] >> shift) | (m_words[word + 1] << (64 - shift));
+    }
+
+    int WalkabilityGrid::next_walkable(const Point& from) const
+    {
+        for (int x = from.x; x < m_size.x; x += 64) {
+            const uint64_t bits = row_bits(x, from.y);
+            if (bits) {
+                return Math::min(x + std::countr_zero(bits), m_size.x);
+            }
+        }
+        return m_size.x;
+    }
+
+    int WalkabilityGrid::next_blocked(const Point& from) const
+    {
+        for (int x = from.x; x < m_size.x; x += 64) {
+            const uint64_t bits = ~row_bits(x, from.y);
+            if (bits) {
+                return Math::min(x + std::countr_zero(bits), m_size.x);
+            }
+        }
+        return m_size.x;
+    }
+}
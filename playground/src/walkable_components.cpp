@@ -0,0 +1,296 @@
+// walkable_components.cpp
+
+#include "walkable_components.hpp"
+#include "world.hpp"
+#include <algorithm>
+
+namespace sim
+{
+    namespace
+    {
+        constexpr Point DIRECTIONS[] = { {0, -1}, {0, 1}, {-1, 0}, {1, 0} };
+    }
+
+    void WalkableComponents::rebuild(const World& world)
+    {
+        m_size = world.m_world_size;
+        const int count = m_size.x * m_size.y;
+        m_label.assign(count, NONE);
+        m_id_parent.clear();
+        m_id_size.clear();
+        m_visit_stamp.assign(count, 0);
+        m_visit_flood.assign(count, 0);
+        m_visit_generation = 0;
+
+        const WalkabilityGrid& walkable = world.m_walkable;
+        std::vector<int>& queue = m_floods[0].m_tiles;
+        for (int y = 0; y < m_size.y; y++) {
+            //Seeds come from runs of walkable tiles, blocked stretches are skipped 64 tiles at a time
+            for (int x = walkable.next_walkable(Point(0, y)); x < m_size.x; x = walkable.next_walkable(Point(x, y))) {
+                const int end = walkable.next_blocked(Point(x, y));
+                for (; x < end; x++) {
+                    const int seed = y * m_size.x + x;
+                    if (m_label[seed] != NONE) {
+                        continue;
+                    }
+                    const int id = make_id(0);
+                    queue.clear();
+                    queue.push_back(seed);
+                    m_label[seed] = id;
+                    for (size_t head = 0; head < queue.size(); head++) {
+                        const Point coord(queue[head] % m_size.x, queue[head] / m_size.x);
+                        for (const Point& d : DIRECTIONS) {
+                            const Point next = coord + d;
+                            const int index = next.y * m_size.x + next.x;
+                            if (walkable.test(next) && m_label[index] == NONE) {
+                                m_label[index] = id;
+                                queue.push_back(index);
+                            }
+                        }
+                    }
+                    m_id_size[id] = (int)queue.size();
+                }
+            }
+        }
+    }
+
+    void WalkableComponents::on_walkability_changed(const World& world, const Point& coord)
+    {
+        if (!is_built() || m_size.x != world.m_world_size.x || m_size.y != world.m_world_size.y) {
+            rebuild(world);
+            return;
+        }
+        //Ids are never reused, start over once the dead ones clearly outnumber the tiles
+        if ((int)m_id_parent.size() > 2 * (int)m_label.size() + 64) {
+            rebuild(world);
+            return;
+        }
+        const int index = coord.y * m_size.x + coord.x;
+        if (world.is_walkable(coord)) {
+            if (m_label[index] == NONE) {
+                on_opened(index);
+            }
+        }
+        else if (m_label[index] != NONE) {
+            on_closed(index);
+        }
+    }
+
+    int WalkableComponents::component(const Point& coord) const
+    {
+        if (coord.has_negative() || coord.x >= m_size.x || coord.y >= m_size.y) {
+            return NONE;
+        }
+        const int label = m_label[coord.y * m_size.x + coord.x];
+        return label == NONE ? NONE : find(label);
+    }
+
+    int WalkableComponents::component_near(const Point& coord) const
+    {
+        int result = component(coord);
+        for (int d = 0; d < 4 && result == NONE; d++) {
+            result = component(coord + DIRECTIONS[d]);
+        }
+        return result;
+    }
+
+    bool WalkableComponents::reachable(const Point& start, const Point& goal) const
+    {
+        if (!is_built() || start == goal) {
+            return true;
+        }
+        const int target = component(goal);
+        if (target == NONE) {
+            return false;
+        }
+        if (component(start) == target) {
+            return true;
+        }
+        //Searches may step off a blocked start onto any walkable neighbour
+        if (component(start) == NONE) {
+            for (const Point& d : DIRECTIONS) {
+                if (component(start + d) == target) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    int WalkableComponents::find(int id) const
+    {
+        while (m_id_parent[id] != id) {
+            id = m_id_parent[id];
+        }
+        return id;
+    }
+
+    int WalkableComponents::unite(int a, int b)
+    {
+        a = find(a);
+        b = find(b);
+        if (a == b) {
+            return a;
+        }
+        if (m_id_size[a] < m_id_size[b]) { // note: union by size keeps find() logarithmic without path compression
+            std::swap(a, b);
+        }
+        m_id_parent[b] = a;
+        m_id_size[a] += m_id_size[b];
+        return a;
+    }
+
+    int WalkableComponents::make_id(int size)
+    {
+        const int id = (int)m_id_parent.size();
+        m_id_parent.push_back(id);
+        m_id_size.push_back(size);
+        return id;
+    }
+
+    void WalkableComponents::on_opened(int index)
+    {
+        const Point coord(index % m_size.x, index / m_size.x);
+        int root = NONE;
+        for (const Point& d : DIRECTIONS) {
+            const int neighbor = component(coord + d);
+            if (neighbor != NONE) {
+                root = root == NONE ? neighbor : unite(root, neighbor);
+            }
+        }
+        if (root == NONE) {
+            root = make_id(0);
+        }
+        m_label[index] = root;
+        m_id_size[root]++;
+    }
+
+    void WalkableComponents::on_closed(int index)
+    {
+        const int root = find(m_label[index]);
+        m_label[index] = NONE;
+        m_id_size[root]--;
+
+        m_visit_generation++;
+        if (m_visit_generation == 0) { //Stamps wrapped around, start over from a clean slate
+            std::fill(m_visit_stamp.begin(), m_visit_stamp.end(), 0u);
+            m_visit_generation = 1;
+        }
+
+        //One flood per walkable neighbour, floods that touch are the same piece
+        const Point coord(index % m_size.x, index / m_size.x);
+        int flood_count = 0;
+        for (const Point& d : DIRECTIONS) {
+            const Point next = coord + d;
+            if (component(next) == NONE) {
+                continue;
+            }
+            const int start = next.y * m_size.x + next.x;
+            Flood& flood = m_floods[flood_count];
+            flood.m_tiles.clear();
+            flood.m_tiles.push_back(start);
+            flood.m_head = 0;
+            flood.m_group = flood_count;
+            m_visit_stamp[start] = m_visit_generation;
+            m_visit_flood[start] = uint8_t(flood_count);
+            flood_count++;
+        }
+        if (flood_count <= 1) {
+            return;
+        }
+
+        auto group_of = [this](int flood) {
+            while (m_floods[flood].m_group != flood) {
+                flood = m_floods[flood].m_group;
+            }
+            return flood;
+            };
+        auto is_done = [&](int group) { // note: a group is done once none of its floods can grow
+            for (int f = 0; f < flood_count; f++) {
+                if (group_of(f) == group && m_floods[f].m_head < m_floods[f].m_tiles.size()) {
+                    return false;
+                }
+            }
+            return true;
+            };
+        auto open_groups = [&]() {
+            int groups = 0;
+            int open = 0;
+            for (int f = 0; f < flood_count; f++) {
+                if (group_of(f) == f) {
+                    groups++;
+                    open += is_done(f) ? 0 : 1;
+                }
+            }
+            return std::make_pair(groups, open);
+            };
+
+        //Grow every flood one tile at a time until at most one separate piece is still growing
+        for (;;) {
+            const auto [groups, open] = open_groups();
+            if (groups == 1 || open <= 1) {
+                break;
+            }
+            for (int f = 0; f < flood_count; f++) {
+                Flood& flood = m_floods[f];
+                if (flood.m_head >= flood.m_tiles.size()) {
+                    continue;
+                }
+                const int current = flood.m_tiles[flood.m_head++];
+                const Point at(current % m_size.x, current / m_size.x);
+                for (const Point& d : DIRECTIONS) {
+                    const Point next = at + d;
+                    if (component(next) == NONE) {
+                        continue;
+                    }
+                    const int neighbor = next.y * m_size.x + next.x;
+                    if (m_visit_stamp[neighbor] != m_visit_generation) {
+                        m_visit_stamp[neighbor] = m_visit_generation;
+                        m_visit_flood[neighbor] = uint8_t(f);
+                        flood.m_tiles.push_back(neighbor);
+                    }
+                    else {
+                        const int a = group_of(f);
+                        const int b = group_of(m_visit_flood[neighbor]);
+                        if (a != b) {
+                            m_floods[std::max(a, b)].m_group = std::min(a, b);
+                        }
+                    }
+                }
+            }
+        }
+
+        //Finished pieces are cut off, the one still growing (or the last one) keeps the old id
+        int keep = -1;
+        for (int f = 0; f < flood_count; f++) {
+            if (group_of(f) == f && !is_done(f)) {
+                keep = f;
+            }
+        }
+        for (int f = 0; f < flood_count && keep == -1; f++) {
+            if (group_of(f) == f) {
+                keep = f;
+            }
+        }
+        for (int group = 0; group < flood_count; group++) {
+            if (group_of(group) != group || group == keep) {
+                continue;
+            }
+            int size = 0;
+            for (int f = 0; f < flood_count; f++) {
+                if (group_of(f) == group) {
+                    size += (int)m_floods[f].m_tiles.size();
+                }
+            }
+            const int id = make_id(size);
+            for (int f = 0; f < flood_count; f++) {
+                if (group_of(f) == group) {
+                    for (int tile : m_floods[f].m_tiles) {
+                        m_label[tile] = id;
+                    }
+                }
+            }
+            m_id_size[root] -= size;
+        }
+    }
+}
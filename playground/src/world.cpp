@@ -2,26 +2,93 @@
 
 #include "world.hpp"
 #include "entity.hpp"
+#include <algorithm>
 #include <iostream>
+#include <utility>
 #include "float.h"
 
 namespace sim
 {
     constexpr float TILE_SIZE = 32.0f;
 
+    namespace {
+        template <typename PositionOf>
+        void ids_in_radius(const SpatialHash& hash, int count, PositionOf position_of,
+                           const Vector2& center, float radius, std::vector<int>& ids)
+        {
+            ids.clear();
+            auto visit = [&](int id) {
+                if (id < count && Vector2Distance(center, position_of(id)) < radius) {
+                    ids.push_back(id);
+                }
+                };
+            if (!hash.m_buckets.empty()) {
+                hash.for_each_in_box(Vector2Subtract(center, { radius, radius }), Vector2Add(center, { radius, radius }), visit);
+            }
+            for (int id = hash.size(); id < count; id++) {
+                visit(id);
+            }
+            std::sort(ids.begin(), ids.end());
+        }
+
+        // note: walks the rings outwards until the k-th best beats everything a further ring can hold
+        template <typename PositionOf, typename Accept>
+        void nearest_ids(const SpatialHash& hash, int count, PositionOf position_of, Accept accept,
+                         const Vector2& center, float radius, int k, std::vector<int>& ids)
+        {
+            thread_local std::vector<std::pair<float, int>> best;
+            best.clear();
+            ids.clear();
+            if (k <= 0) {
+                return;
+            }
+
+            auto visit = [&](int id) {
+                if (id >= count || !accept(id)) {
+                    return;
+                }
+                const std::pair<float, int> entry(Vector2Distance(center, position_of(id)), id);
+                if (!(entry.first < radius) || ((int)best.size() == k && !(entry < best.back()))) {
+                    return;
+                }
+                best.insert(std::upper_bound(best.begin(), best.end(), entry), entry);
+                if ((int)best.size() > k) {
+                    best.pop_back();
+                }
+                };
+            if (!hash.m_buckets.empty()) {
+                const Point cell = hash.cell_coord(center);
+                const int rings = hash.max_ring(cell);
+                for (int ring = 0; ring <= rings; ring++) {
+                    const float reach = float((ring - 1) * hash.m_cell_size);
+                    if (ring > 0 && (reach >= radius || ((int)best.size() == k && best.back().first < reach))) {
+                        break;
+                    }
+                    hash.for_each_in_ring(cell, ring, visit);
+                }
+            }
+            for (int id = hash.size(); id < count; id++) {
+                visit(id);
+            }
+            for (const auto& entry : best) {
+                ids.push_back(entry.second);
+            }
+        }
+    }
+
     World::World()
         : m_tile_size(TILE_SIZE, TILE_SIZE)
     {
-        m_sheep.reserve(200);// Avoid memory crash
+        m_sheep.reserve(200);
         m_wolf.reserve(150);
-        m_manure.reserve(100);
 
         for (int i = 0; i < 40; i++) {
-            m_sheep.push_back(std::make_shared<Sheep>(*this));
+            m_sheep.spawn(Vector2{}, Vector2{}, 0.0f);
         }
 
         for (int i = 0; i < 3; i++) {
             m_wolf.emplace_back(*this);
+            m_wolf_handles.create(i);
         }
     }
 
@@ -37,16 +104,54 @@ namespace sim
         if (!is_valid_coord(coord)) {
             return false;
         }
-        return m_ground[coord.y * m_world_size.x + coord.x].is_walkable();
+        return m_walkable.test(coord);
     }
 
-    bool World::has_grass_at(const Point& coord) const
+    void World::set_walkable(const Point& coord, bool state)
     {
         if (!is_valid_coord(coord)) {
+            return;
+        }
+        if (m_walkable.test(coord) == state) {
+            return;
+        }
+        m_walkable.set(coord, state);
+        m_walkability_epoch++;
+        m_walkability_log[m_walkability_epoch % WALKABILITY_LOG_SIZE] = coord;
+        m_components.on_walkability_changed(*this, coord);
+        // note: jump distances of a row depend on the rows directly above and below it
+        m_jump_table.rebuild_rows(*this, coord.y - 1, coord.y + 1);
+        m_path_hierarchy.on_walkability_changed(*this, coord);
+    }
+
+    bool World::walkability_changes_since(uint32_t epoch, std::vector<Point>& changes) const
+    {
+        changes.clear();
+        if (m_walkability_epoch - epoch > uint32_t(WALKABILITY_LOG_SIZE)) {
             return false;
         }
-        const Grass& grass = m_grass[coord.y * m_world_size.x + coord.x];
-        return m_grass[coord.y * m_world_size.x + coord.x].is_alive();
+        for (uint32_t e = epoch; e != m_walkability_epoch;) {
+            const Point& coord = m_walkability_log[++e % WALKABILITY_LOG_SIZE];
+            if (coord.has_negative()) {
+                return false;
+            }
+            changes.push_back(coord);
+        }
+        return true;
+    }
+
+    bool World::has_grass_at(const Point& coord) const
+    {
+        return m_grass_index.test(coord);
+    }
+
+    void World::on_grass_changed(const Point& coord)
+    {
+        if (!is_valid_coord(coord)) {
+            return;
+        }
+        m_grass_index.set(coord, m_grass.is_alive(coord));
+        m_grass_field.on_grass_changed(*this, coord);
     }
 
     Point World::position_to_tile_coord(const Vector2& position) const
@@ -68,20 +173,14 @@ namespace sim
 
     Point World::findNearestGrass(const Point& start) const
     {
-        float minDist = FLT_MAX;
         Point nearest = { -1, -1 };
+        //Grass outside our own walkable region can never be reached, so it never counts as nearest
+        const int region = m_components.component_near(start);
 
-        for (const auto& grass : m_grass) {
-            if (grass.is_alive()) {
-                Point grassCoord = grass.m_tile_coord;
-                float dist = Vector2Distance(start.to_vec2(), grassCoord.to_vec2());
-                if (dist < minDist) {
-                    minDist = dist;
-                    nearest = grassCoord;
-                }
-            }
-        }
-        if (!is_valid_coord(nearest)) {
+        const bool found = m_grass_index.nearest(start, [this, region](const Point& coord) {
+            return region == WalkableComponents::NONE || m_components.component(coord) == region;
+            }, nearest);
+        if (!found) {
             return { 0, 0 };
         }
 
@@ -91,21 +190,160 @@ namespace sim
     Point World::findNearestSheep(const Point& start) const
     {
         float minDist = FLT_MAX;
+        int nearestIndex = -1;
         Point nearest = { -1, -1 };
+        const int region = m_components.component_near(start);
+
+        auto visit = [&](int index) {
+            if (m_sheep.m_state[index] == Sheep::SheepState::DEAD) {
+                return;
+            }
+            Point sheepCoord = position_to_tile_coord(m_sheep.m_position[index]);
+            if (region != WalkableComponents::NONE && m_components.component(sheepCoord) != region) {
+                return;
+            }
+            float dist = Vector2Distance(start.to_vec2(), sheepCoord.to_vec2());
+            if (dist < minDist || (dist == minDist && index < nearestIndex)) {
+                minDist = dist;
+                nearestIndex = index;
+                nearest = sheepCoord;
+            }
+            };
 
-        for (const auto& sheep : m_sheep) {
-            if (sheep->getState() != Sheep::SheepState::DEAD) {
-                Point sheepCoord = position_to_tile_coord(sheep->m_position);
-                float dist = Vector2Distance(start.to_vec2(), sheepCoord.to_vec2());
-                if (dist < minDist) {
-                    minDist = dist;
-                    nearest = sheepCoord;
+        //Rings of cells outwards from the start, a sheep in ring r is at least (r - 1) cells of tiles away
+        const int count = m_sheep.size();
+        if (!m_sheep_hash.m_buckets.empty()) {
+            const Point cell = m_sheep_hash.cell_coord(tile_coord_to_position(start));
+            const int rings = m_sheep_hash.max_ring(cell);
+            for (int ring = 0; ring <= rings; ring++) {
+                if (ring > 0 && minDist < float((ring - 1) * AGENT_CELL_TILES)) {
+                    break;
                 }
+                m_sheep_hash.for_each_in_ring(cell, ring, [&](int index) {
+                    if (index < count) {
+                        visit(index);
+                    }
+                    });
             }
         }
+        for (int index = m_sheep_hash.size(); index < count; index++) {
+            visit(index);
+        }
         return nearest;
     }
 
+    void World::index_sheep()
+    {
+        const Point cells((m_world_size.x + AGENT_CELL_TILES - 1) / AGENT_CELL_TILES,
+                          (m_world_size.y + AGENT_CELL_TILES - 1) / AGENT_CELL_TILES);
+        m_sheep_hash.reset(m_world_offset, cells, AGENT_CELL_TILES * m_tile_size.x);
+        for (int i = 0; i < m_sheep.size(); i++) {
+            m_sheep_hash.insert(i, m_sheep.m_position[i]);
+            m_max_agent_radius = std::max(m_max_agent_radius, m_sheep.m_radius[i]);
+        }
+    }
+
+    void World::index_wolves()
+    {
+        const Point cells((m_world_size.x + AGENT_CELL_TILES - 1) / AGENT_CELL_TILES,
+                          (m_world_size.y + AGENT_CELL_TILES - 1) / AGENT_CELL_TILES);
+        m_wolf_hash.reset(m_world_offset, cells, AGENT_CELL_TILES * m_tile_size.x);
+        for (int i = 0; i < (int)m_wolf.size(); i++) {
+            m_wolf_hash.insert(i, m_wolf[i].m_position);
+            m_max_agent_radius = std::max(m_max_agent_radius, m_wolf[i].m_radius);
+        }
+    }
+
+    void World::sheep_in_radius(const Vector2& center, float radius, std::vector<int>& indices) const
+    {
+        ids_in_radius(m_sheep_hash, m_sheep.size(),
+            [this](int i) { return m_sheep.m_position[i]; }, center, radius, indices);
+    }
+
+    void World::wolves_in_radius(const Vector2& center, float radius, std::vector<int>& indices) const
+    {
+        ids_in_radius(m_wolf_hash, (int)m_wolf.size(),
+            [this](int i) { return m_wolf[i].m_position; }, center, radius, indices);
+    }
+
+    void World::nearest_sheep(const Vector2& center, float radius, int k, std::vector<int>& indices) const
+    {
+        nearest_ids(m_sheep_hash, m_sheep.size(),
+            [this](int i) { return m_sheep.m_position[i]; },
+            [this](int i) { return m_sheep.m_state[i] != Sheep::SheepState::DEAD; },
+            center, radius, k, indices);
+    }
+
+    void World::nearest_sheep(const Vector2& center, float radius, int k, const std::function<bool(int)>& accept, std::vector<int>& indices) const
+    {
+        nearest_ids(m_sheep_hash, m_sheep.size(),
+            [this](int i) { return m_sheep.m_position[i]; },
+            [this, &accept](int i) { return m_sheep.m_state[i] != Sheep::SheepState::DEAD && accept(i); },
+            center, radius, k, indices);
+    }
+
+    void World::nearest_wolves(const Vector2& center, float radius, int k, std::vector<int>& indices) const
+    {
+        nearest_ids(m_wolf_hash, (int)m_wolf.size(),
+            [this](int i) { return m_wolf[i].m_position; },
+            [](int) { return true; },
+            center, radius, k, indices);
+    }
+
+    std::vector<Point> World::find_path(const Point& start, const Point& goal)
+    {
+        return find_path(start, goal, m_path_algorithm);
+    }
+
+    std::vector<Point> World::find_path(const Point& start, const Point& goal, PathAlgorithm algorithm)
+    {
+        std::vector<Point> path;
+        if (find_path_cached(start, goal, algorithm, path)) {
+            return path;
+        }
+        path = findPath(*this, start, goal, algorithm);
+        store_path(start, goal, algorithm, path);
+        return path;
+    }
+
+    bool World::find_path_cached(const Point& start, const Point& goal, PathAlgorithm algorithm, std::vector<Point>& path)
+    {
+        if (!m_components.reachable(start, goal)) {
+            path.clear();
+            return true;
+        }
+        return m_path_cache.lookup({ start, goal, m_walkability_epoch, algorithm }, path);
+    }
+
+    void World::store_path(const Point& start, const Point& goal, PathAlgorithm algorithm, const std::vector<Point>& path)
+    {
+        m_path_cache.store({ start, goal, m_walkability_epoch, algorithm }, path);
+    }
+
+    uint32_t World::request_path(const Point& start, const Point& goal, PathPriority priority)
+    {
+        return request_path(start, goal, m_path_algorithm, priority);
+    }
+
+    uint32_t World::request_path(const Point& start, const Point& goal, PathAlgorithm algorithm, PathPriority priority)
+    {
+        return m_path_requests.submit(start, goal, algorithm, priority);
+    }
+
+    bool World::claim_path(uint32_t& ticket, Path& path)
+    {
+        std::vector<Point> tiles;
+        if (!m_path_requests.claim(ticket, tiles)) {
+            return false;
+        }
+        path.assign_smoothed(*this, std::move(tiles));
+        return true;
+    }
+
+    void World::cancel_path(uint32_t& ticket)
+    {
+        m_path_requests.cancel(ticket);
+    }
 
     void World::toggleDebugPath() {
         m_debugPathVisible = !m_debugPathVisible;
@@ -113,22 +351,26 @@ namespace sim
 
     void World::selectEntity(const Vector2& pos) {
         m_selectedEntity.type = EntityType::None;
-        m_selectedEntity.entity = nullptr;
+        m_selectedEntity.handle = Handle{};
         const float tolerance = 10.0f;
         // Clear the current selection before each selection, avoid keeping the previous selection
-        for (auto& sheep : m_sheep) {
-            float distance = Vector2Distance(pos, sheep->m_position);
-            if (distance < sheep->m_radius + tolerance) {
+        std::vector<int> nearby;
+        sheep_in_radius(pos, m_max_agent_radius + tolerance, nearby);
+        for (int index : nearby) {
+            float distance = Vector2Distance(pos, m_sheep.m_position[index]);
+            if (distance < m_sheep.m_radius[index] + tolerance) {
                 m_selectedEntity.type = EntityType::Sheep;
-                m_selectedEntity.entity = sheep.get();// Save the original pointer for debugging rendering
+                m_selectedEntity.handle = m_sheep.handle(index);// Survives the sweeps of the dead for debugging rendering
                 return;
             }
         }
-        for (auto& wolf : m_wolf) {
+        wolves_in_radius(pos, m_max_agent_radius + tolerance, nearby);
+        for (int index : nearby) {
+            auto& wolf = m_wolf[index];
             float distance = Vector2Distance(pos, wolf.m_position);
             if (distance < wolf.m_radius + tolerance) {
                 m_selectedEntity.type = EntityType::Wolf;
-                m_selectedEntity.entity = &wolf;
+                m_selectedEntity.handle = m_wolf_handles.handle_of(index);
                 return;
             }
         }
@@ -136,9 +378,26 @@ namespace sim
             float distance = Vector2Distance(pos, m_herder->get_position());
             if (distance < 25.0f + tolerance) {
                 m_selectedEntity.type = EntityType::Herder;
-                m_selectedEntity.entity = m_herder.get();
+                m_selectedEntity.handle = m_herder_handles.handle_of(0);
                 return;
             }
         }
     }
-}
\ No newline at end of file
+
+    Wolf* World::resolve_wolf(const Handle& handle)
+    {
+        const int index = m_wolf_handles.resolve(handle);
+        return index == HandleTable::NONE ? nullptr : &m_wolf[index];
+    }
+
+    const Wolf* World::resolve_wolf(const Handle& handle) const
+    {
+        const int index = m_wolf_handles.resolve(handle);
+        return index == HandleTable::NONE ? nullptr : &m_wolf[index];
+    }
+
+    Herder* World::resolve_herder(const Handle& handle) const
+    {
+        return m_herder_handles.resolve(handle) == HandleTable::NONE ? nullptr : m_herder.get();
+    }
+}
@@ -6,15 +6,22 @@
 namespace sim
 {
     void World::init(int width, int height, Texture* texture, Texture* pTexture, Texture *hTexture)
+    {
+        const int columns = (width / m_tile_size.x) - TILE_PADDING_X;
+        const int rows = (height / m_tile_size.y) - TILE_PADDING_Y;
+        init(Point(columns, rows), width, height, texture, pTexture, hTexture);
+    }
+
+    void World::init(const Point& world_size, int width, int height, Texture* texture, Texture* pTexture, Texture* hTexture)
     {
         m_texture = texture;
         m_wolfTexture = pTexture;
         m_herderTexture = hTexture;
 
-        const int columns = (width / m_tile_size.x) - TILE_PADDING_X;
-        const int rows = (height / m_tile_size.y) - TILE_PADDING_Y;
-        const int start_x = (width - (columns * m_tile_size.x)) / 2;
-        const int start_y = (height - (rows * m_tile_size.y)) / 2;
+        const int columns = world_size.x;
+        const int rows = world_size.y;
+        const int start_x = Math::max(0, (width - (columns * m_tile_size.x)) / 2);
+        const int start_y = Math::max(0, (height - (rows * m_tile_size.y)) / 2);
 
         // note: world settings
         m_world_size = { columns, rows };
@@ -27,44 +34,25 @@ namespace sim
         };
 
         { // note: initialize ground layer
-            m_ground.resize(columns * rows);
-
-            int ground_tile_index = 0;
-            for (Ground& ground : m_ground) {
-                const int x = (ground_tile_index % columns);
-                const int y = (ground_tile_index / columns);
-                ground_tile_index++;
-
-                const Point tile_coord{ x, y };
-                ground.set_tile_coord(tile_coord);
-                ground.set_walkable(true);
-            }
+            m_walkable.reset(m_world_size, true);
+            rebuild_navigation();
         }
 
         { // note: initialize grass layer
-            m_grass = std::vector<Grass>();
-            m_grass.reserve(m_world_size.x * m_world_size.y);
-            m_grass.resize(m_world_size.x * m_world_size.y);
-
-            int grass_tile_index = 0;
-            for (Grass& grass : m_grass) {
-                const int x = (grass_tile_index % columns);
-                const int y = (grass_tile_index / columns);
-                grass_tile_index++;
-
-                const Point tile_coord{ x, y };
-                grass.set_tile_coord(tile_coord);
-                int chance = GetRandomValue(0, 100);
-                if (chance < 7) {
-                    grass.m_state = Grass::GrassState::GERMINATION;
-                    float age = (float)GetRandomValue(1, 100) / 100.0f;
-                    grass.set_age(age);
-                }
-                else {
-                    grass.m_state = Grass::GrassState::NONE;
-                    grass.set_age(-1.0f);
+            m_grass.resize(m_world_size); // note: every tile bare, at age -1
+
+            for (int y = 0; y < rows; y++) {
+                for (int x = 0; x < columns; x++) {
+                    int chance = m_random.range(0, 100);
+                    if (chance < 7) {
+                        float age = (float)m_random.range(1, 100) / 100.0f;
+                        m_grass.set(Point(x, y), Grass::GrassState::GERMINATION, age);
+                    }
                 }
             }
+            m_grass_index.rebuild(*this);
+            m_grass_field.rebuild(*this);
+            m_manure.reset(m_world_size);
         }
 
         { // note: initialize sheep
@@ -72,18 +60,18 @@ namespace sim
             const float target_distance = 70.0f;
             const Rectangle source{ 0, 60, 50, 30 };
             const Vector2 origin = Vector2Scale(Vector2{ source.width, source.height }, 0.5f);
-            for (auto& sheep : m_sheep) {
-                const int x = GetRandomValue(int(m_world_bounds.x), int(m_world_bounds.x + m_world_bounds.width));
-                const int y = GetRandomValue(int(m_world_bounds.y), int(m_world_bounds.y + m_world_bounds.height));
-                const float theta = ((float)GetRandomValue(0, 100) * 0.01f) * (180.0f / 3.14159257f);
+            for (int i = 0; i < m_sheep.size(); i++) {
+                const int x = m_random.range(int(m_world_bounds.x), int(m_world_bounds.x + m_world_bounds.width));
+                const int y = m_random.range(int(m_world_bounds.y), int(m_world_bounds.y + m_world_bounds.height));
+                const float theta = ((float)m_random.range(0, 100) * 0.01f) * (180.0f / 3.14159257f);
                 const Vector2 position{ (float)x, (float)y };
                 const Vector2 direction{ std::cos(theta), std::sin(theta) };
 
-                sheep->set_position(position);
-                sheep->set_radius(radius);
-                sheep->set_direction(direction);
-                sheep->set_sprite_origin(origin);
-                sheep->set_sprite_source(source);
+                m_sheep.m_position[i] = position;
+                m_sheep.m_radius[i] = radius;
+                m_sheep.m_direction[i] = direction;
+                m_sheep.m_cold[i].m_origin = origin;
+                m_sheep.m_cold[i].m_source = source;
 
             }
         }
@@ -94,8 +82,8 @@ namespace sim
             Vector2 origin = Vector2Scale(Vector2{ source.width, source.height }, 0.5f);
 
             for (auto& wolf : m_wolf) {
-                int x = GetRandomValue(int(m_world_bounds.x), int(m_world_bounds.x + m_world_bounds.width));
-                int y = GetRandomValue(int(m_world_bounds.y), int(m_world_bounds.y + m_world_bounds.height));
+                int x = m_random.range(int(m_world_bounds.x), int(m_world_bounds.x + m_world_bounds.width));
+                int y = m_random.range(int(m_world_bounds.y), int(m_world_bounds.y + m_world_bounds.height));
                 Vector2 position{ (float)x, (float)y };
 
                 wolf.set_position(position);
@@ -106,9 +94,24 @@ namespace sim
         }
 
         m_herder = std::make_unique<Herder>(*this, m_herderTexture);
+        m_herder_handles.clear();
+        m_herder_handles.create(0);
         Vector2 herderPos = { m_world_bounds.x + m_world_bounds.width / 2,
                               m_world_bounds.y + m_world_bounds.height / 2 };
         m_herder->set_position(herderPos);
+
+        index_sheep();
+        index_wolves();
+        remember_positions();
+    }
+
+    void World::rebuild_navigation()
+    {
+        m_walkability_epoch++;
+        m_walkability_log[m_walkability_epoch % WALKABILITY_LOG_SIZE] = Point(-1, -1);
+        m_components.rebuild(*this);
+        m_jump_table.rebuild(*this);
+        m_path_hierarchy.rebuild(*this);
     }
 
     void World::shut()
@@ -11,17 +11,25 @@ namespace sim
         const Vector2 ZERO{};
         const Vector2 tile_size = m_tile_size.to_vec2();
 
+        //Only the tiles on screen are drawn, the world can be far larger than the window
+        const Point first(Math::max(0, -m_world_offset.x / m_tile_size.x), Math::max(0, -m_world_offset.y / m_tile_size.y));
+        const Point last(Math::min(m_world_size.x, (GetScreenWidth() - m_world_offset.x) / m_tile_size.x + 1),
+                         Math::min(m_world_size.y, (GetScreenHeight() - m_world_offset.y) / m_tile_size.y + 1));
+
         { // note: render ground
             constexpr Rectangle source{ 0.0f, 0.0f, 16.0f, 16.0f };
 
-            for (const Ground& ground : m_ground) {
-                if (!ground.is_walkable()) {
-                    continue;
-                }
+            for (int y = first.y; y < last.y; y++) {
+                for (int x = first.x; x < last.x; x++) {
+                    const Point tile_coord(x, y);
+                    if (!m_walkable.test(tile_coord)) {
+                        continue;
+                    }
 
-                const Vector2 position = (m_world_offset + ground.m_tile_coord * m_tile_size).to_vec2();
-                const Rectangle destination{ position.x, position.y, tile_size.x, tile_size.y };
-                DrawTexturePro(*m_texture, source, destination, ZERO, 0.0f, WHITE);
+                    const Vector2 position = (m_world_offset + tile_coord * m_tile_size).to_vec2();
+                    const Rectangle destination{ position.x, position.y, tile_size.x, tile_size.y };
+                    DrawTexturePro(*m_texture, source, destination, ZERO, 0.0f, WHITE);
+                }
             }
         }
 
@@ -36,15 +44,18 @@ namespace sim
                     {96.0f, 0.0f, 16.0f, 16.0f},
             };
 
-            for (const Grass& tile : m_grass) {
-                if (!tile.is_alive()) {
-                    continue;
+            for (int y = first.y; y < last.y; y++) {
+                for (int x = first.x; x < last.x; x++) {
+                    const Point tile_coord(x, y);
+                    if (!m_grass.is_alive(tile_coord)) {
+                        continue;
+                    }
+                    const int index = static_cast<int>(m_grass.state(tile_coord));
+                    const Vector2 position = (m_world_offset + tile_coord * m_tile_size).to_vec2();
+                    const Rectangle source = sources[index];
+                    const Rectangle destination{ position.x, position.y, tile_size.x, tile_size.y };
+                    DrawTexturePro(*m_texture, source, destination, ZERO, 0.0f, WHITE);
                 }
-                const int index = static_cast<int>(tile.m_state);
-                const Vector2 position = (m_world_offset + tile.m_tile_coord * m_tile_size).to_vec2();
-                const Rectangle source = sources[index];
-                const Rectangle destination{ position.x, position.y, tile_size.x, tile_size.y };
-                DrawTexturePro(*m_texture, source, destination, ZERO, 0.0f, WHITE);
             }
         }
 
@@ -60,91 +71,118 @@ namespace sim
             DrawText(TextFormat("HP:%d", HP), (int)position.x, (int)position.y - 35, 14, WHITE);
             };
 
+        //Agents are drawn between their last two ticks, m_render_alpha says how far along
+        const float alpha = m_render_alpha;
+        auto sheep_position = [&](int i) { return Vector2Lerp(m_sheep.m_previous_position[i], m_sheep.m_position[i], alpha); };
+        auto wolf_position = [&](const Wolf& wolf) { return Vector2Lerp(wolf.m_previous_position, wolf.m_position, alpha); };
+
         // note: render sheep
-        for (const auto& sheep : m_sheep) {
-            sheep->render(*m_texture);
-            drawHealthBar(sheep->m_position, sheep->HP, SHEEP_MAX_HP);
+        for (int i = 0; i < m_sheep.size(); i++) {
+            m_sheep.render(i, *m_texture, alpha);
+            drawHealthBar(sheep_position(i), m_sheep.m_hp[i], SHEEP_MAX_HP);
         }
 
         for (const auto& wolf : m_wolf) {
-            wolf.render(*m_wolfTexture);
-            drawHealthBar(wolf.m_position, wolf.HP, SHEEP_MAX_HP);
+            wolf.render(*m_wolfTexture, alpha);
+            drawHealthBar(wolf_position(wolf), wolf.HP, SHEEP_MAX_HP);
         }
 
-        for (const auto& manure : m_manure) {
-            manure.render(*m_texture);
+        for (int slot : m_manure.m_live) {
+            m_manure[slot].render(*m_texture);
         }
         if (m_debugPathVisible) {
             // Print route
-            for (const auto& sheep : m_sheep) {
-                if (sheep->m_path.size() > 1) {
-                    for (size_t i = 0; i + 1 < sheep->m_path.size(); ++i) {
-                        if (!is_valid_coord(position_to_tile_coord(sheep->m_position))) {
-                            continue;
+            for (int s = 0; s < m_sheep.size(); s++) {
+                const Path& path = m_sheep.m_cold[s].m_path;
+                if (path.size() > 1 && is_valid_coord(position_to_tile_coord(m_sheep.m_position[s]))) {
+                    Point previous = path.front();
+                    path.for_each([&](const Point& waypoint) { //The front is visited first and only sets the start
+                        if (!(waypoint == previous)) {
+                            DrawLineV(tile_coord_to_position(previous), tile_coord_to_position(waypoint), GREEN);
                         }
-                        Vector2 pos1 = tile_coord_to_position(sheep->m_path[i]);
-                        Vector2 pos2 = tile_coord_to_position(sheep->m_path[i + 1]);
-                        DrawLineV(pos1, pos2, GREEN);
-                    }
+                        previous = waypoint;
+                        });
                 }
             }
 
             for (const auto& wolf : m_wolf) {
-                if (wolf.m_path.size() > 1) {
-                    for (size_t i = 0; i + 1 < wolf.m_path.size(); ++i) {
-                        Vector2 pos1 = tile_coord_to_position(wolf.m_path[i]);
-                        Vector2 pos2 = tile_coord_to_position(wolf.m_path[i + 1]);
-                        if (!is_valid_coord(position_to_tile_coord(wolf.m_position))) {
-                            continue;
+                if (wolf.m_path.size() > 1 && is_valid_coord(position_to_tile_coord(wolf.m_position))) {
+                    Point previous = wolf.m_path.front();
+                    wolf.m_path.for_each([&](const Point& waypoint) { //The front is visited first and only sets the start
+                        if (!(waypoint == previous)) {
+                            DrawLineV(tile_coord_to_position(previous), tile_coord_to_position(waypoint), RED);
                         }
-                        DrawLineV(pos1, pos2, RED);
-                    }
+                        previous = waypoint;
+                        });
                 }
             }
-            for (const auto& sheep : m_sheep) {
+            for (int i = 0; i < m_sheep.size(); i++) {
+                const Vector2 position = sheep_position(i);
                 DrawText(
-                    TextFormat("State: %s", SheepStateToString(sheep->m_state)),
-                    static_cast<int>(sheep->m_position.x),
-                    static_cast<int>(sheep->m_position.y) - 20,
+                    TextFormat("State: %s", SheepStateToString(m_sheep.m_state[i])),
+                    static_cast<int>(position.x),
+                    static_cast<int>(position.y) - 20,
                     10,
                     WHITE
                 );
             }
             for (const auto& wolf : m_wolf) {
+                const Vector2 position = wolf_position(wolf);
                 DrawText(
                     TextFormat("State: %s", WolfStateToString(wolf.m_state)),
-                    static_cast<int>(wolf.m_position.x),
-                    static_cast<int>(wolf.m_position.y) - 20,
+                    static_cast<int>(position.x),
+                    static_cast<int>(position.y) - 20,
                     10,
                     WHITE
                 );
             }
 
             if (m_herder) {
-                m_herder->render();
+                m_herder->render(alpha);
             }
+
+            DrawText(TextFormat("Path cache: %llu lookups, %.1f%% hits (%llu suffix)",
+                (unsigned long long)m_path_cache.m_lookups,
+                m_path_cache.hit_rate() * 100.0f,
+                (unsigned long long)m_path_cache.m_suffix_hits),
+                2, GetScreenHeight() - 40, 10, WHITE);
+            DrawText(TextFormat("Path requests: %d queued, %llu solved, %llu ticks over budget",
+                (int)m_path_requests.pending(),
+                (unsigned long long)m_path_requests.m_solved,
+                (unsigned long long)m_path_requests.m_deferred_ticks),
+                2, GetScreenHeight() - 52, 10, WHITE);
         }
 
         if (m_selectedEntity.type != EntityType::None) 
         {
             Vector2 debugPos = { 0, 0 };
             char debugText[128] = { 0 };
+            const Handle& handle = m_selectedEntity.handle;
             switch (m_selectedEntity.type) {
             case EntityType::Sheep: {
-                Sheep* s = static_cast<Sheep*>(m_selectedEntity.entity);
-                debugPos = s->m_position;
-                sprintf_s(debugText, sizeof(debugText), "Sheep: State=%d, HP=%d, Hunger=%.1f", s->m_state, s->HP, s->m_hunger);
+                const int s = m_sheep.resolve(handle);
+                if (s == Sheep::NONE) {
+                    return;
+                }
+                debugPos = sheep_position(s);
+                sprintf_s(debugText, sizeof(debugText), "Sheep: State=%d, HP=%d, Hunger=%.1f", (int)m_sheep.m_state[s], m_sheep.m_hp[s], m_sheep.m_hunger[s]);
                 break;
             }// Help observing the behavior, judgment, and survival of entities
             case EntityType::Wolf: {
-                Wolf* w = static_cast<Wolf*>(m_selectedEntity.entity);
-                debugPos = w->m_position;
+                const Wolf* w = resolve_wolf(handle);
+                if (!w) {
+                    return;
+                }
+                debugPos = wolf_position(*w);
                 sprintf_s(debugText, sizeof(debugText), "Wolf: State=%d, HP=%d, Hunger=%.1f", w->m_state, w->HP, w->m_hunger);
                 break;
             }
             case EntityType::Herder: {
-                Herder* h = static_cast<Herder*>(m_selectedEntity.entity);
-                debugPos = h->get_position();
+                const Herder* h = resolve_herder(handle);
+                if (!h) {
+                    return;
+                }
+                debugPos = Vector2Lerp(h->m_previous_position, h->get_position(), alpha);
                 sprintf_s(debugText, sizeof(debugText), "Herder: PathLen=%d", (int)h->m_path.size());
                 break;
             }
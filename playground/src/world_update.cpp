@@ -1,6 +1,7 @@
 // world_update.cpp
 
 #include "world.hpp"
+#include <algorithm>
 
 namespace sim
 {
@@ -26,37 +27,53 @@ namespace sim
         }
     }
 
-    bool World::update(float dt)
+    void World::handle_input(const InputSource& input)
     {
-        if (IsKeyReleased(KEY_ESCAPE)) {
+        if (input.quit_requested()) {
             m_running = false;
         }
-
-        for (auto& grass : m_grass) {
-            grass.update(dt);
+        Vector2 target{};
+        if (m_herder && input.move_requested(target)) {
+            m_herder->request_move(target);
         }
+    }
 
+    void World::remember_positions()
+    {
+        std::copy(m_sheep.m_position.begin(), m_sheep.m_position.end(), m_sheep.m_previous_position.begin());
         for (auto& wolf : m_wolf) {
-            wolf.update(dt);
-            contain_within_bounds(wolf, m_world_bounds);
+            wolf.m_previous_position = wolf.m_position;
         }
+        if (m_herder) {
+            m_herder->m_previous_position = m_herder->m_position;
+        }
+    }
 
-        for (auto& sheep : m_sheep) {
-            sheep->update(dt);
-            contain_within_bounds(*sheep, m_world_bounds);
+    bool World::update(float dt)
+    {
+        remember_positions();
+        m_grass.update(dt);
+        for (const Point& coord : m_grass.m_revived) { //Growing never kills grass, only regrowing eaten grass changes liveness
+            on_grass_changed(coord);
         }
+        m_grass_field.update(*this);
+        m_path_requests.process(*this);
 
-        for (auto& manure : m_manure) {
-            manure.update(dt);
+        for (auto& wolf : m_wolf) {
+            wolf.update(dt);
+            contain_within_bounds(wolf, m_world_bounds);
         }
+        index_wolves();
+        match_partners();
+
+        m_sheep.update(*this, 0, m_sheep.size(), dt);
 
-        m_wolf.erase(std::remove_if(m_wolf.begin(), m_wolf.end(),
-            [](const Wolf& w) { return w.m_state == Wolf::WolfState::DEAD; }),
-            m_wolf.end());
+        m_manure.update(dt);
 
-        m_manure.erase(std::remove_if(m_manure.begin(), m_manure.end(),
-            [](const Manure& m) { return !m.m_isActive; }),
-            m_manure.end()); 
+        //Births and deaths wait until here so indices into m_sheep stay valid for the whole tick
+        m_commands.apply(*this);
+        index_sheep();
+        index_wolves();
 
         if (m_herder) {
             m_herder->update(dt);
@@ -64,4 +81,62 @@ namespace sim
 
         return m_running;
     }
+
+    void World::match_partners()
+    {
+        const int count = m_sheep.size();
+        m_mate_ready.assign(count, 0);
+        m_mate_taken.assign(count, 0);
+        m_mate_candidates.clear();
+        m_matches.clear();
+        for (int i = 0; i < count; i++) {
+            m_mate_ready[i] = m_sheep.ready_to_mate(i) ? 1 : 0;
+            m_sheep.m_cold[i].m_suitor = Sheep::NONE;
+        }
+
+        //Every close pair of ready sheep is a candidate, each found once from its lower index
+        std::vector<int> nearby;
+        for (int i = 0; i < count; i++) {
+            if (!m_mate_ready[i]) {
+                continue;
+            }
+            sheep_in_radius(m_sheep.m_position[i], MATE_RADIUS, nearby);
+            for (int j : nearby) {
+                const bool grazing = m_sheep.m_state[i] == Sheep::SheepState::EATING &&
+                                     m_sheep.m_state[j] == Sheep::SheepState::EATING;
+                if (j > i && m_mate_ready[j] && !grazing) { //Two grazing sheep keep eating, one of them has to come over
+                    m_mate_candidates.push_back({ Vector2Distance(m_sheep.m_position[i], m_sheep.m_position[j]), i, j });
+                }
+            }
+        }
+
+        //Closest pairs claim their sheep first, equal distances go by index so the outcome never depends on visiting order
+        std::sort(m_mate_candidates.begin(), m_mate_candidates.end(), [](const MatePair& a, const MatePair& b) {
+            if (a.m_distance != b.m_distance) return a.m_distance < b.m_distance;
+            if (a.m_first != b.m_first) return a.m_first < b.m_first;
+            return a.m_second < b.m_second;
+            });
+        for (const MatePair& pair : m_mate_candidates) {
+            if (m_mate_taken[pair.m_first] || m_mate_taken[pair.m_second]) {
+                continue;
+            }
+            m_mate_taken[pair.m_first] = 1;
+            m_mate_taken[pair.m_second] = 1;
+            m_matches.push_back(pair);
+            m_sheep.pair(pair.m_first, m_sheep.handle(pair.m_second), true);
+            m_sheep.pair(pair.m_second, m_sheep.handle(pair.m_first), false);
+        }
+
+        //Whoever is still free courts the nearest other free sheep
+        for (int i = 0; i < count; i++) {
+            if (!m_mate_ready[i] || m_mate_taken[i]) {
+                continue;
+            }
+            nearest_sheep(m_sheep.m_position[i], COURTSHIP_RADIUS, 1,
+                [this, i](int j) { return j != i && m_mate_ready[j] && !m_mate_taken[j]; }, nearby);
+            if (!nearby.empty()) {
+                m_sheep.m_cold[i].m_suitor = nearby.front();
+            }
+        }
+    }
 }